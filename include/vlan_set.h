@@ -0,0 +1,118 @@
+/*
+ * (C) Copyright 2016 Hewlett Packard Enterprise Development LP
+ * All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-vland
+ *
+ * @file
+ * Compact set of VLAN IDs.
+ *
+ * A vlan_set picks one of three representations from the shape of its
+ * contents:
+ *
+ *   - ARRAY:  up to VLAN_SET_MAX_INLINE VIDs, sorted, stored inline.  This
+ *             covers access ports and small trunks without any heap memory.
+ *   - RANGES: a sorted list of disjoint, non-adjacent VID ranges, used
+ *             while it is smaller than a bitmap.
+ *   - BITMAP: a dense vland_bitmap.
+ *
+ * The representation is chosen whenever a set is built from a bitmap;
+ * single VID updates keep the current one as long as it can hold the
+ * result.  All representations give the same results for every operation.
+ ***************************************************************************/
+
+#ifndef __VLAN_SET_H__
+#define __VLAN_SET_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct vland_bitmap;
+
+#define VLAN_SET_MAX_INLINE  8
+
+enum vlan_set_type {
+    VLAN_SET_ARRAY,
+    VLAN_SET_RANGES,
+    VLAN_SET_BITMAP
+};
+
+struct vlan_range {
+    uint16_t first;
+    uint16_t last;
+};
+
+struct vlan_set {
+    uint8_t type;               /*!< One of enum vlan_set_type. */
+    uint16_t count;             /*!< Number of VIDs in the set. */
+    uint16_t n;                 /*!< ARRAY: VIDs, RANGES: ranges in use. */
+    uint16_t allocated;         /*!< RANGES: ranges allocated. */
+    union {
+        uint16_t vids[VLAN_SET_MAX_INLINE];
+        struct vlan_range *ranges;
+        struct vland_bitmap *bitmap;
+    } u;
+};
+
+#define VLAN_SET_INITIALIZER { VLAN_SET_ARRAY, 0, 0, 0, { { 0 } } }
+
+struct vlan_set_iter {
+    const struct vlan_set *set;
+    size_t idx;
+    int vid;
+};
+
+extern void vlan_set_init(struct vlan_set *set);
+extern void vlan_set_destroy(struct vlan_set *set);
+
+extern bool vlan_set_contains(const struct vlan_set *set, int vid);
+extern void vlan_set_add(struct vlan_set *set, int vid);
+extern void vlan_set_remove(struct vlan_set *set, int vid);
+
+extern void vlan_set_from_bitmap(struct vlan_set *set,
+                                 const struct vland_bitmap *bitmap);
+extern void vlan_set_or_into_bitmap(const struct vlan_set *set,
+                                    struct vland_bitmap *bitmap);
+
+extern size_t vlan_set_heap_bytes(const struct vlan_set *set);
+extern const char *vlan_set_type_name(const struct vlan_set *set);
+
+extern int vlan_set_iter_first(struct vlan_set_iter *iter,
+                               const struct vlan_set *set);
+extern int vlan_set_iter_next(struct vlan_set_iter *iter);
+
+static inline size_t
+vlan_set_count(const struct vlan_set *set)
+{
+    return set->count;
+}
+
+static inline bool
+vlan_set_is_empty(const struct vlan_set *set)
+{
+    return !set->count;
+}
+
+/* Iterates VID over the members of SET in ascending order, using ITER, a
+ * struct vlan_set_iter.  SET must not be modified during the iteration. */
+#define VLAN_SET_FOR_EACH(VID, ITER, SET)                   \
+    for ((VID) = vlan_set_iter_first(&(ITER), SET);         \
+         (VID) >= 0;                                        \
+         (VID) = vlan_set_iter_next(&(ITER)))
+
+#endif /* __VLAN_SET_H__ */
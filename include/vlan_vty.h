@@ -28,6 +28,7 @@
 #define _VLAN_VTY_H
 
 #include "ops-utils.h"
+#include "vlan-bitmap.h"
 
 /* vlan length + 1 */
 #define VLAN_ID_LEN 5
@@ -51,6 +52,7 @@
 #define OVSDB_INTF_VLAN_REMOVE_TRUNK_NATIVE_TAG_ERROR "Failed to remove native VLAN tagging on the interface%s"
 #define DEFAULT_INTERNAL_VLAN_MIN_VID_VALUE 1024
 #define DEFAULT_INTERNAL_VLAN_MAX_VID_VALUE 4094
+/* Deprecated: kept for other vtysh modules. */
 extern int compare_nodes_by_vlan_id_in_numerical(const void *a_,
                                                    const void *b_);
 extern const struct shash_node **sort_vlan_id(const struct shash *sh);
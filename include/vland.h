@@ -75,6 +75,9 @@
  *
  *     Other options:
  *       --unixctl=SOCKET        override default control socket name
+ *       --resync-threads=N      use N threads for a full cache resync
+ *                               (default: 1)
+ *       --pipeline              compute VLAN state on a separate thread
  *       -h, --help              display this help message
  *
  *
@@ -129,6 +132,8 @@
 #ifndef __VLAND_H__
 #define __VLAND_H__
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <dynamic-string.h>
 
 /**************************************************************************//**
@@ -145,6 +150,25 @@ extern void vland_run(void);
  *****************************************************************************/
 extern void vland_wait(void);
 
+/**************************************************************************//**
+ * @details This function is called during ops-vland start up, before
+ * vland_ovsdb_init(), to set the number of threads, counting the main
+ * thread, that handle a full resync of the port and VLAN caches.
+ *
+ * @param[in] n_threads - number of resync threads.
+ *****************************************************************************/
+extern void vland_ovsdb_set_resync_threads(size_t n_threads);
+
+/**************************************************************************//**
+ * @details This function is called during ops-vland start up, before
+ * vland_ovsdb_init(), to select the pipelined mode, in which VLAN state is
+ * computed on a separate thread while the main thread processes OVSDB
+ * updates and commits VLAN status.
+ *
+ * @param[in] enable - true to use the pipelined mode.
+ *****************************************************************************/
+extern void vland_ovsdb_set_pipeline(bool enable);
+
 /**************************************************************************//**
  * @details This function is called during ops-vland start up to initialize
  * the OVSDB IDL interface and cache all necessary tables & columns.
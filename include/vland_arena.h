@@ -0,0 +1,76 @@
+/*
+ * (C) Copyright 2016 Hewlett Packard Enterprise Development LP
+ * All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-vland
+ *
+ * @file
+ * Bump allocator for data that only lives for one reconfigure pass.
+ *
+ * Allocations are carved out of large blocks and are never freed one by
+ * one; vland_arena_reset() releases all of them at once.  The memory is
+ * kept for the next pass, so once the arena has grown to the size of a
+ * typical pass it does no further heap allocation.
+ ***************************************************************************/
+
+#ifndef __VLAND_ARENA_H__
+#define __VLAND_ARENA_H__
+
+#include <stddef.h>
+
+struct vland_arena_block;
+
+struct vland_arena {
+    struct vland_arena_block *blocks;  /*!< Current block first. */
+    size_t block_size;                 /*!< Size of the next new block. */
+    size_t high_water;                 /*!< Largest total use in one pass. */
+    size_t used;                       /*!< Total use in this pass. */
+};
+
+#define VLAND_ARENA_INITIALIZER { NULL, 0, 0, 0 }
+
+/**************************************************************************//**
+ * @details Initializes 'arena' to allocate blocks of at least 'block_size'
+ * bytes.  No memory is allocated until the first vland_arena_alloc().
+ *****************************************************************************/
+extern void vland_arena_init(struct vland_arena *arena, size_t block_size);
+
+/**************************************************************************//**
+ * @details Frees all memory held by 'arena'.
+ *****************************************************************************/
+extern void vland_arena_destroy(struct vland_arena *arena);
+
+/**************************************************************************//**
+ * @details Returns 'size' bytes of uninitialized memory from 'arena',
+ * aligned for any type.  The memory stays valid until the next
+ * vland_arena_reset() or vland_arena_destroy().
+ *****************************************************************************/
+extern void *vland_arena_alloc(struct vland_arena *arena, size_t size);
+
+/**************************************************************************//**
+ * @details Like vland_arena_alloc(), but zeroes the memory.
+ *****************************************************************************/
+extern void *vland_arena_zalloc(struct vland_arena *arena, size_t size);
+
+/**************************************************************************//**
+ * @details Releases every allocation made from 'arena' since the last
+ * reset.  If the pass needed more than one block, the blocks are replaced
+ * by a single block big enough for the whole pass.
+ *****************************************************************************/
+extern void vland_arena_reset(struct vland_arena *arena);
+
+#endif /* __VLAND_ARENA_H__ */
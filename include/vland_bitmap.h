@@ -0,0 +1,143 @@
+/*
+ * (C) Copyright 2016 Hewlett Packard Enterprise Development LP
+ * All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-vland
+ *
+ * @file
+ * Fixed-size bitmap with one bit per VLAN ID.
+ *
+ * Unlike the generic OVS bitmaps, a vland_bitmap has a size known at
+ * compile time and is cache-line aligned, so it can live in static storage
+ * or inside other structures and the whole-bitmap operations run over a
+ * fixed number of aligned words.  Those operations use AVX2, or POPCNT
+ * for counting, when the CPU has them; vland_bitmap_init() picks the
+ * implementation once at startup.  Until then, and on other architectures,
+ * portable code is used.
+ ***************************************************************************/
+
+#ifndef __VLAND_BITMAP_H__
+#define __VLAND_BITMAP_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define VLAND_BITMAP_BITS   4096
+#define VLAND_BITMAP_ULONG_BITS  (sizeof(unsigned long) * 8)
+#define VLAND_BITMAP_LONGS  (VLAND_BITMAP_BITS / VLAND_BITMAP_ULONG_BITS)
+
+struct vland_bitmap {
+    unsigned long bits[VLAND_BITMAP_LONGS];
+} __attribute__((aligned(64)));
+
+/**************************************************************************//**
+ * @details Selects the fastest implementation of the whole-bitmap operations
+ * the CPU supports.  Returns the name of the implementation selected.
+ *****************************************************************************/
+extern const char *vland_bitmap_init(void);
+
+/**************************************************************************//**
+ * @details Returns the name of the implementation in use.
+ *****************************************************************************/
+extern const char *vland_bitmap_impl_name(void);
+
+/**************************************************************************//**
+ * @details Sets 'dst' to 'dst' | 'src'.
+ *****************************************************************************/
+extern void vland_bitmap_or(struct vland_bitmap *dst,
+                            const struct vland_bitmap *src);
+
+/**************************************************************************//**
+ * @details Sets 'dst' to 'dst' & ~'src'.
+ *****************************************************************************/
+extern void vland_bitmap_andnot(struct vland_bitmap *dst,
+                                const struct vland_bitmap *src);
+
+/**************************************************************************//**
+ * @details Sets 'delta' to the bits that differ between 'a' and 'b'.
+ * Returns true if there is any.  Iterate the changed bits with
+ * VLAND_BITMAP_FOR_EACH_1.
+ *****************************************************************************/
+extern bool vland_bitmap_xor(struct vland_bitmap *delta,
+                             const struct vland_bitmap *a,
+                             const struct vland_bitmap *b);
+
+/**************************************************************************//**
+ * @details Returns the number of bits set in 'b'.
+ *****************************************************************************/
+extern size_t vland_bitmap_count(const struct vland_bitmap *b);
+
+/**************************************************************************//**
+ * @details Returns the index of the first bit at or after 'start' that is
+ * 1 if 'target' is true or 0 otherwise, or VLAND_BITMAP_BITS if none.
+ *****************************************************************************/
+extern int vland_bitmap_scan(const struct vland_bitmap *b, bool target,
+                             int start);
+
+extern bool vland_bitmap_is_empty(const struct vland_bitmap *b);
+
+static inline void
+vland_bitmap_zero(struct vland_bitmap *b)
+{
+    *b = (struct vland_bitmap) { { 0 } };
+}
+
+static inline void
+vland_bitmap_copy(struct vland_bitmap *dst, const struct vland_bitmap *src)
+{
+    *dst = *src;
+}
+
+static inline bool
+vland_bitmap_is_set(const struct vland_bitmap *b, int idx)
+{
+    return (b->bits[idx / VLAND_BITMAP_ULONG_BITS]
+            >> (idx % VLAND_BITMAP_ULONG_BITS)) & 1;
+}
+
+static inline void
+vland_bitmap_set1(struct vland_bitmap *b, int idx)
+{
+    b->bits[idx / VLAND_BITMAP_ULONG_BITS]
+        |= 1UL << (idx % VLAND_BITMAP_ULONG_BITS);
+}
+
+static inline void
+vland_bitmap_set0(struct vland_bitmap *b, int idx)
+{
+    b->bits[idx / VLAND_BITMAP_ULONG_BITS]
+        &= ~(1UL << (idx % VLAND_BITMAP_ULONG_BITS));
+}
+
+static inline void
+vland_bitmap_set(struct vland_bitmap *b, int idx, bool value)
+{
+    if (value) {
+        vland_bitmap_set1(b, idx);
+    } else {
+        vland_bitmap_set0(b, idx);
+    }
+}
+
+/* Iterates IDX, an int, over the bits set in the vland_bitmap pointed to
+ * by BITMAP, in ascending order. */
+#define VLAND_BITMAP_FOR_EACH_1(IDX, BITMAP)                        \
+    for ((IDX) = vland_bitmap_scan(BITMAP, true, 0);                \
+         (IDX) < VLAND_BITMAP_BITS;                                 \
+         (IDX) = vland_bitmap_scan(BITMAP, true, (IDX) + 1))
+
+#endif /* __VLAND_BITMAP_H__ */
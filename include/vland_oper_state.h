@@ -0,0 +1,60 @@
+/*
+ * (C) Copyright 2016 Hewlett Packard Enterprise Development LP
+ * All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-vland
+ *
+ * @file
+ * Rule that derives a VLAN's operational state from its inputs.
+ *
+ * Both the main loop and the pipelined compute stage (vland_pipeline.h)
+ * use it, so the two modes cannot disagree on a VLAN's state.
+ ***************************************************************************/
+
+#ifndef __VLAND_OPER_STATE_H__
+#define __VLAND_OPER_STATE_H__
+
+#include <stdbool.h>
+
+#include <openswitch-idl.h>
+
+/* VLAN created by ops-vland at start up.  It is always operationally up. */
+#define VLAND_DEFAULT_VID  1
+
+/* Sets *STATE and *REASON for a VLAN with ID 'vid', administratively up if
+ * 'admin_up', that has a member port if 'any_member'.  See
+ * calc_vlan_op_state_n_reason() for the table of states and reasons. */
+static inline void
+vland_oper_state_calc(int vid, bool admin_up, bool any_member,
+                      enum ovsrec_vlan_oper_state_e *state,
+                      enum ovsrec_vlan_oper_state_reason_e *reason)
+{
+    /* The default VLAN is up even without member ports. */
+    *state = (vid == VLAND_DEFAULT_VID
+              ? VLAN_OPER_STATE_UP : VLAN_OPER_STATE_DOWN);
+
+    if (!admin_up) {
+        *reason = VLAN_OPER_STATE_REASON_ADMIN_DOWN;
+    } else if (!any_member) {
+        *reason = VLAN_OPER_STATE_REASON_NO_MEMBER_PORT;
+    } else {
+        *state = VLAN_OPER_STATE_UP;
+        *reason = VLAN_OPER_STATE_REASON_OK;
+    }
+}
+
+#endif /* __VLAND_OPER_STATE_H__ */
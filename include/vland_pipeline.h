@@ -0,0 +1,158 @@
+/*
+ * (C) Copyright 2016 Hewlett Packard Enterprise Development LP
+ * All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-vland
+ *
+ * @file
+ * Compute stage of the pipelined mode of ops-vland.
+ *
+ * In pipelined mode the main thread, which owns the OVSDB IDL, turns Port
+ * and VLAN row changes into self-contained change records and submits them
+ * to a compute thread over a lock-free ring.  The compute thread keeps its
+ * own copy of port VLAN membership and per-VLAN member counts, works out
+ * which VLANs changed operational state, and hands the new states back in
+ * batches over a second ring.  The main thread writes each batch of states
+ * to OVSDB in one transaction.  The compute thread never touches the IDL,
+ * so the main thread can process the next OVSDB updates meanwhile.
+ ***************************************************************************/
+
+#ifndef __VLAND_PIPELINE_H__
+#define __VLAND_PIPELINE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <uuid.h>
+#include <openswitch-idl.h>
+
+struct vland_pipeline;
+
+enum vland_change_type {
+    VLAND_CHANGE_PORT,          /*!< Port added or modified. */
+    VLAND_CHANGE_PORT_DEL,      /*!< Port deleted. */
+    VLAND_CHANGE_VLAN,          /*!< VLAN added or modified. */
+    VLAND_CHANGE_VLAN_DEL,      /*!< VLAN deleted. */
+};
+
+/**************************************************************************//**
+ * A change to one Port or VLAN row, reduced to the inputs of VLAN state.
+ * A record is a single allocation from vland_change_create(); whoever
+ * holds it last frees it with free().
+ *****************************************************************************/
+struct vland_change {
+    enum vland_change_type type;
+    struct uuid uuid;           /*!< UUID of the Port or VLAN row. */
+
+    /* VLAND_CHANGE_VLAN and VLAND_CHANGE_VLAN_DEL. */
+    int vid;                    /*!< "id" column. */
+    bool admin_up;              /*!< "admin" column is "up". */
+    bool internal;              /*!< VLAN is used internally for L3. */
+
+    /* VLAND_CHANGE_PORT and VLAND_CHANGE_PORT_DEL. */
+    bool in_bridge;             /*!< Port is in a bridge. */
+    bool trunk_all;             /*!< Port implicitly trunks all VLANs. */
+    bool default_member;        /*!< "tag" or "trunks" has the default VLAN. */
+    int native_vid;             /*!< Native VID, or -1 if none. */
+    size_t n_trunks;
+    uint16_t trunks[];          /*!< "trunks" column, if used by the mode. */
+};
+
+/**************************************************************************//**
+ * @details Returns a new zeroed record of 'type' with room for 'n_trunks'
+ * trunks.
+ *****************************************************************************/
+extern struct vland_change *vland_change_create(enum vland_change_type type,
+                                                size_t n_trunks);
+
+/* New operational state of one VLAN.  'uuid' and 'vid' are those of the
+ * VLAND_CHANGE_VLAN record the state was computed for; the row may have
+ * been deleted, or its "id" changed, by the time the state is collected. */
+struct vland_state_delta {
+    struct uuid uuid;
+    uint16_t vid;
+    bool any_member;
+    enum ovsrec_vlan_oper_state_e state;
+    enum ovsrec_vlan_oper_state_reason_e reason;
+};
+
+/* Operational states that changed while the compute stage applied one
+ * batch of change records, in the order they were computed.  Free with
+ * free(). */
+struct vland_delta_batch {
+    size_t n;
+    struct vland_state_delta deltas[];
+};
+
+/* Counters kept by the compute stage. */
+struct vland_pipeline_stats {
+    uint64_t n_changes;         /*!< Change records applied. */
+    uint64_t n_batches;         /*!< Delta batches produced. */
+    uint64_t n_deltas;          /*!< State deltas produced. */
+    uint64_t compute_usec;      /*!< Time spent applying records. */
+};
+
+/**************************************************************************//**
+ * @details Starts a compute thread whose rings hold 'capacity' change
+ * records and delta batches.
+ *****************************************************************************/
+extern struct vland_pipeline *vland_pipeline_create(size_t capacity);
+
+/**************************************************************************//**
+ * @details Stops and joins the compute thread of 'pipeline' and frees it,
+ * including any records and batches still queued.
+ *****************************************************************************/
+extern void vland_pipeline_destroy(struct vland_pipeline *pipeline);
+
+/**************************************************************************//**
+ * @details Queues 'change' for the compute stage, which takes ownership of
+ * it.  Returns false if the ring is full; the caller keeps 'change' and
+ * should try again after the next vland_pipeline_wait() wakeup.  Changes
+ * are applied in the order they are submitted.  Call vland_pipeline_flush()
+ * once the changes of a pass are submitted.
+ *****************************************************************************/
+extern bool vland_pipeline_submit(struct vland_pipeline *pipeline,
+                                  struct vland_change *change);
+
+/**************************************************************************//**
+ * @details Wakes up the compute stage to apply the changes submitted so far.
+ *****************************************************************************/
+extern void vland_pipeline_flush(struct vland_pipeline *pipeline);
+
+/**************************************************************************//**
+ * @details Returns the next batch of state deltas, or NULL if there is
+ * none.  The caller frees the batch.  Call this until it returns NULL on
+ * every pass that calls vland_pipeline_submit(), before submitting.
+ *****************************************************************************/
+extern struct vland_delta_batch *
+vland_pipeline_next_deltas(struct vland_pipeline *pipeline);
+
+/**************************************************************************//**
+ * @details Arranges for the poll loop to wake up when a new delta batch is
+ * ready or the change ring has room again.
+ *****************************************************************************/
+extern void vland_pipeline_wait(struct vland_pipeline *pipeline);
+
+/**************************************************************************//**
+ * @details Sets 'stats' to the compute stage counters of 'pipeline'.  The
+ * counters are read without stopping the compute thread.
+ *****************************************************************************/
+extern void vland_pipeline_get_stats(const struct vland_pipeline *pipeline,
+                                     struct vland_pipeline_stats *stats);
+
+#endif /* __VLAND_PIPELINE_H__ */
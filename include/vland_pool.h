@@ -0,0 +1,74 @@
+/*
+ * (C) Copyright 2016 Hewlett Packard Enterprise Development LP
+ * All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-vland
+ *
+ * @file
+ * Fixed-size object pool for long-lived ops-vland cache entries.
+ *
+ * Objects of one type are carved out of cache-line aligned slabs, so that
+ * they are packed together in memory and each object starts on its own
+ * cache line.  Freed objects go on a free list for reuse; slabs are only
+ * returned to the system by vland_pool_destroy().
+ ***************************************************************************/
+
+#ifndef __VLAND_POOL_H__
+#define __VLAND_POOL_H__
+
+#include <stddef.h>
+
+struct vland_pool_slab;
+
+struct vland_pool {
+    size_t obj_size;                 /*!< Object size, cache-line rounded. */
+    size_t objs_per_slab;            /*!< Objects carved from each slab. */
+    struct vland_pool_slab *slabs;   /*!< All slabs, newest first. */
+    void *free_list;                 /*!< Objects available for reuse. */
+    size_t n_slabs;                  /*!< Number of slabs. */
+    size_t n_used;                   /*!< Objects currently allocated. */
+};
+
+/**************************************************************************//**
+ * @details Initializes 'pool' for objects of 'obj_size' bytes, allocated
+ * 'objs_per_slab' at a time.
+ *****************************************************************************/
+extern void vland_pool_init(struct vland_pool *pool, size_t obj_size,
+                            size_t objs_per_slab);
+
+/**************************************************************************//**
+ * @details Frees all slabs of 'pool'.  Every object allocated from it
+ * becomes invalid.
+ *****************************************************************************/
+extern void vland_pool_destroy(struct vland_pool *pool);
+
+/**************************************************************************//**
+ * @details Returns a zeroed, cache-line aligned object from 'pool'.
+ *****************************************************************************/
+extern void *vland_pool_alloc(struct vland_pool *pool);
+
+/**************************************************************************//**
+ * @details Returns 'obj', allocated from 'pool', to 'pool'.
+ *****************************************************************************/
+extern void vland_pool_free(struct vland_pool *pool, void *obj);
+
+/**************************************************************************//**
+ * @details Returns the number of bytes of memory held by 'pool'.
+ *****************************************************************************/
+extern size_t vland_pool_bytes(const struct vland_pool *pool);
+
+#endif /* __VLAND_POOL_H__ */
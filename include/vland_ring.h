@@ -0,0 +1,66 @@
+/*
+ * (C) Copyright 2016 Hewlett Packard Enterprise Development LP
+ * All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-vland
+ *
+ * @file
+ * Bounded lock-free queue of pointers between exactly one producer thread
+ * and exactly one consumer thread.
+ *
+ * Neither side ever blocks or takes a lock: vland_ring_push() fails when
+ * the ring is full and vland_ring_pop() returns NULL when it is empty.
+ * Waking up the other side is left to the caller, e.g. with a seq.
+ ***************************************************************************/
+
+#ifndef __VLAND_RING_H__
+#define __VLAND_RING_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+struct vland_ring;
+
+/**************************************************************************//**
+ * @details Creates a ring that holds at least 'capacity' pointers.  The
+ * capacity is rounded up to a power of 2.
+ *****************************************************************************/
+extern struct vland_ring *vland_ring_create(size_t capacity);
+
+/**************************************************************************//**
+ * @details Frees 'ring'.  Pointers still in it are not freed.
+ *****************************************************************************/
+extern void vland_ring_destroy(struct vland_ring *ring);
+
+/**************************************************************************//**
+ * @details Returns the number of pointers 'ring' can hold.
+ *****************************************************************************/
+extern size_t vland_ring_capacity(const struct vland_ring *ring);
+
+/**************************************************************************//**
+ * @details Adds 'p', which must not be NULL, to 'ring'.  Returns false,
+ * without adding it, if 'ring' is full.  Only the producer may call this.
+ *****************************************************************************/
+extern bool vland_ring_push(struct vland_ring *ring, void *p);
+
+/**************************************************************************//**
+ * @details Removes and returns the oldest pointer in 'ring', or returns
+ * NULL if 'ring' is empty.  Only the consumer may call this.
+ *****************************************************************************/
+extern void *vland_ring_pop(struct vland_ring *ring);
+
+#endif /* __VLAND_RING_H__ */
@@ -0,0 +1,86 @@
+/*
+ * (C) Copyright 2016 Hewlett Packard Enterprise Development LP
+ * All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-vland
+ *
+ * @file
+ * Fork-join worker pool for bulk ops-vland work.
+ *
+ * The calling thread hands the same function to every worker and takes a
+ * share of the work itself, then waits until all workers are done.  While
+ * a job runs the calling thread does nothing else, so the job may read any
+ * state the calling thread owns, including the OVSDB IDL, as long as it
+ * does not modify it.
+ ***************************************************************************/
+
+#ifndef __VLAND_WORKERS_H__
+#define __VLAND_WORKERS_H__
+
+#include <stddef.h>
+
+struct vland_workers;
+
+/* A job run by each of 'n' workers; 'idx' is in [0, n), and the calling
+ * thread is worker 0. */
+typedef void vland_work_func(void *aux, size_t idx, size_t n);
+
+/**************************************************************************//**
+ * @details Creates a pool of 'n_threads' workers, counting the calling
+ * thread.  Returns NULL if 'n_threads' is less than 2; vland_workers_run()
+ * then runs jobs on the calling thread alone.
+ *****************************************************************************/
+extern struct vland_workers *vland_workers_create(size_t n_threads);
+
+/**************************************************************************//**
+ * @details Stops and joins all threads of 'workers' and frees it.
+ *****************************************************************************/
+extern void vland_workers_destroy(struct vland_workers *workers);
+
+/**************************************************************************//**
+ * @details Returns the number of workers in 'workers', counting the calling
+ * thread.  Returns 1 for a NULL pool.
+ *****************************************************************************/
+extern size_t vland_workers_count(const struct vland_workers *workers);
+
+/**************************************************************************//**
+ * @details Runs 'func' once on every worker of 'workers' and returns when
+ * all of them have finished.
+ *****************************************************************************/
+extern void vland_workers_run(struct vland_workers *workers,
+                              vland_work_func *func, void *aux);
+
+/* Sets *START and *END to the bounds of worker IDX's share of N items split
+ * among N_WORKERS workers, in chunks that are multiples of ALIGN items. */
+static inline void
+vland_workers_split(size_t n, size_t align, size_t idx, size_t n_workers,
+                    size_t *start, size_t *end)
+{
+    size_t chunks = (n + align - 1) / align;
+    size_t per = (chunks + n_workers - 1) / n_workers;
+
+    *start = idx * per * align;
+    *end = (idx + 1) * per * align;
+    if (*start > n) {
+        *start = n;
+    }
+    if (*end > n) {
+        *end = n;
+    }
+}
+
+#endif /* __VLAND_WORKERS_H__ */
@@ -334,3 +334,57 @@ def test_vlan_d(topology, step, setup):
     ops1("no vlan trunk allowed 100")
     ops1("no vlan trunk allowed 300")
     ops1("routing")
+
+
+def test_vlan_hw_config_keys_preserved(topology, step, setup):
+    ops1 = topology.get('ops1')
+
+    assert ops1 is not None
+
+    step("Step 1- Add vlan 400 with an extra hw_vlan_config key")
+    add_vlan(ops1, "400", "400")
+    ops1("set vlan 400 hw_vlan_config:foo=bar", shell="vsctl")
+    set_vlan_admin(ops1, "400", "up")
+
+    step("Step 2- Add port referencing vlan 400")
+    ops1("conf t")
+    ops1("interface 1")
+    ops1("no routing")
+    ops1("vlan access 400")
+    ops1("exit")
+
+    step("Step 3- Verify vlan 400 is enabled and the extra key is kept")
+    data = get_vlan(ops1, "400")
+    assert "enable" in data["hw_vlan_config"]
+    assert "foo=bar" in data["hw_vlan_config"]
+
+    step("Step 4- Set vlan 400 admin down")
+    set_vlan_admin(ops1, "400", "down")
+
+    step("Step 5- Verify only the enable key was removed")
+    data = get_vlan(ops1, "400")
+    assert "enable" not in data["hw_vlan_config"]
+    assert "foo=bar" in data["hw_vlan_config"]
+
+    ops1("interface 1")
+    ops1("routing")
+    ops1("exit")
+
+
+def test_vlan_unconfigured_bridge_port(topology, step, setup):
+    ops1 = topology.get('ops1')
+
+    assert ops1 is not None
+
+    step("Step 1- Add vlan 500 and set it admin up")
+    add_vlan(ops1, "500", "500")
+    set_vlan_admin(ops1, "500", "up")
+
+    step("Step 2- Verify vlan 500 is down (no_member_port)")
+    verify_data(get_vlan(ops1, "500"), "{}", "down", "no_member_port")
+
+    step("Step 3- Add a port without vlan_mode, tag or trunks")
+    ops1("add-port br0 {PORT_1}".format(**globals()), shell="vsctl")
+
+    step("Step 4- Verify vlan 500 is up (ok), the port trunks all vlans")
+    verify_data(get_vlan(ops1, "500"), '{enable=true}', "up", "ok")
@@ -500,6 +500,15 @@ def internalvlanchecks(dut):
     assert (
         'VLAN1024 is used as an internal VLAN. Deletion not allowed.' in ret
     )
+
+    dut('interface lag 34')
+    dut('no routing')
+    ret = dut('vlan trunk allowed 1024')
+    assert 'Error : Vlan ID-1024 is an internal vlan.' in ret
+    ret = dut('do show running-config')
+    assert 'vlan trunk allowed 1024' not in ret
+    dut('exit')
+    dut('no interface lag 34')
     dut('end')
 
 
@@ -539,6 +548,176 @@ def novlantrunkallowed(dut):
     dut('end')
 
 
+def addtrunkvlanrangetointerface(dut):
+    dut('conf t')
+    for vlan in ['30', '31', '32', '34']:
+        dut('vlan ' + vlan)
+        dut('exit')
+    dut('interface 3')
+
+    # A new port is routed, so the range is refused until routing is off.
+    out = dut('vlan trunk allowed 30-31')
+    assert 'Disable routing on the interface 3' in out
+    dut('no routing')
+
+    # A missing VLAN aborts the whole range.
+    out = dut('vlan trunk allowed 30-33')
+    assert 'VLAN 33 not found for interface 3' in out
+    out = dut('do show running-config')
+    assert 'vlan trunk allowed 30' not in out
+
+    dut('vlan trunk allowed 30,31')
+    out = dut('vlan trunk allowed 31-32,34')
+    assert 'The VLAN 31 is already allowed' in out
+    out = dut('do show running-config')
+    assert 'vlan trunk allowed 30-32,34' in out
+
+    dut('end')
+
+
+def addtrunkvlanrangetolag(dut):
+    dut('conf t')
+    dut('interface lag 32')
+    dut('no routing')
+    dut('vlan trunk allowed 30-32')
+    out = dut('do show vlan 30-32')
+    lines = re.findall('^3[0-2]\s+VLAN.*lag32', out, re.MULTILINE)
+    assert len(lines) == 3
+    dut('no vlan trunk allowed 30-32')
+    out = dut('do show vlan 30-32')
+    assert 'lag32' not in out
+    dut('end')
+
+
+def removetrunkvlanrangefrominterface(dut):
+    dut('conf t')
+    for vlan in ['33', '35']:
+        dut('vlan ' + vlan)
+        dut('exit')
+    dut('interface 3')
+    dut('vlan trunk allowed 33,35')
+    out = dut('do show running-config')
+    assert 'vlan trunk allowed 30-35' in out
+
+    # Both ends of the range and the VLANs inside it are removed, and the
+    # VLANs next to it are kept.
+    dut('no vlan trunk allowed 31-33,34')
+    out = dut('do show running-config')
+    assert 'vlan trunk allowed 30,35' in out
+    out = dut('do show vlan 33')
+    assert re.search('^33\s+VLAN33', out, re.MULTILINE)
+    assert not re.search(r'^33\s+VLAN33.*\b3\b', out, re.MULTILINE)
+
+    # The last trunk VLANs can be removed on their own too.
+    dut('no vlan trunk allowed 35')
+    dut('no vlan trunk allowed 30')
+    out = dut('do show running-config')
+    assert 'vlan trunk allowed 30' not in out
+    dut('end')
+
+
+def createvlanrange(dut):
+    dut('conf t')
+    dut('vlan 200')
+    dut('exit')
+    dut('vlan 198-203,205')
+    out = dut('do show vlan')
+    vlans = re.findall('^(\d+)\s+VLAN\d+', out, re.MULTILINE)
+    for vlan in ['198', '199', '200', '201', '202', '203', '205']:
+        assert vlan in vlans
+    assert '204' not in vlans
+    dut('end')
+
+
+def deletevlanrange(dut):
+    dut('conf t')
+    dut('interface 4')
+    dut('no routing')
+    dut('vlan trunk allowed 199')
+    dut('vlan trunk allowed 203')
+    dut('exit')
+    dut('no vlan 198-202,205')
+    out = dut('do show vlan')
+    vlans = re.findall('^(\d+)\s+VLAN\d+', out, re.MULTILINE)
+    for vlan in ['198', '199', '200', '201', '202', '205']:
+        assert vlan not in vlans
+    assert '203' in vlans
+    out = dut('do show running-config')
+    assert 'vlan trunk allowed 199' not in out
+    assert 'vlan trunk allowed 203' in out
+
+    # A range that includes the default VLAN is rejected as a whole.
+    out = dut('no vlan 1-3,203')
+    assert 'Unknown command.' in out
+    out = dut('do show vlan')
+    vlans = re.findall('^(\d+)\s+\S+', out, re.MULTILINE)
+    assert '1' in vlans
+    assert '203' in vlans
+    dut('end')
+
+
+def showvlanfilters(dut):
+    out = dut('show vlan 30-32,203')
+    vlans = re.findall('^(\d+)\s+VLAN\d+', out, re.MULTILINE)
+    assert vlans == ['30', '31', '32', '203']
+
+    out = dut('show vlan 204')
+    assert 'VLAN 204 has not been configured' in out
+
+    out = dut('show vlan interface 4')
+    vlans = re.findall('^(\d+)\s+VLAN\d+', out, re.MULTILINE)
+    assert '203' in vlans
+    for vlan in ['30', '31', '32', '34', '199']:
+        assert vlan not in vlans
+
+    out = dut('show vlan status down')
+    vlans = re.findall('^(\d+)\s+VLAN\d+\s+(\S+)', out, re.MULTILINE)
+    assert ('203', 'down') in vlans
+    for vlan, status in vlans:
+        assert status == 'down'
+
+    # A LAG member interface shows the VLANs of its LAG.
+    dut('conf t')
+    dut('interface lag 33')
+    dut('no routing')
+    dut('vlan trunk allowed 203')
+    dut('exit')
+    dut('interface 5')
+    dut('lag 33')
+    dut('end')
+    out = dut('show vlan interface 5')
+    vlans = re.findall('^(\d+)\s+VLAN\d+.*lag33', out, re.MULTILINE)
+    assert vlans == ['203']
+    dut('conf t')
+    dut('no interface lag 33')
+    dut('end')
+
+
+def runningconfigvlanrange(dut):
+    dut('conf t')
+    dut('vlan 150-155')
+    dut('vlan 153')
+    dut('no shutdown')
+    dut('exit')
+    out = dut('do show running-config')
+    assert re.search('^vlan 150-152$', out, re.MULTILINE)
+    assert re.search('^vlan 153$', out, re.MULTILINE)
+    assert re.search('^vlan 154-155$', out, re.MULTILINE)
+    dut('end')
+
+    # A VLAN with config of another feature keeps its own "vlan" line.
+    uuid = dut('/usr/bin/ovs-vsctl --bare --columns=_uuid find VLAN id=151',
+               shell='bash').strip()
+    dut('/usr/bin/ovs-vsctl set VLAN ' + uuid + ' other_config:test=1',
+        shell='bash')
+    out = dut('show running-config')
+    assert re.search('^vlan 150$', out, re.MULTILINE)
+    assert re.search('^vlan 151$', out, re.MULTILINE)
+    assert re.search('^vlan 152$', out, re.MULTILINE)
+    dut('/usr/bin/ovs-vsctl remove VLAN ' + uuid + ' other_config test',
+        shell='bash')
+
+
 def test_vtysh_ct_vlan(topology, step):
     ops1 = topology.get('ops1')
     assert ops1 is not None
@@ -587,3 +766,24 @@ def test_vtysh_ct_vlan(topology, step):
 
     step('Test to check no vlan trunk allowed')
     novlantrunkallowed(ops1)
+
+    step('Test to add a range of trunk VLANs to interface')
+    addtrunkvlanrangetointerface(ops1)
+
+    step('Test to add a range of trunk VLANs to LAG')
+    addtrunkvlanrangetolag(ops1)
+
+    step('Test to remove a range of trunk VLANs from interface')
+    removetrunkvlanrangefrominterface(ops1)
+
+    step('Test to create a range of VLANs')
+    createvlanrange(ops1)
+
+    step('Test to delete a range of VLANs')
+    deletevlanrange(ops1)
+
+    step('Test "show vlan" range, status and interface filters')
+    showvlanfilters(ops1)
+
+    step('Test compact VLAN ranges in running-config')
+    runningconfigvlanrange(ops1)
@@ -0,0 +1,214 @@
+# -*- coding: utf-8 -*-
+# (C) Copyright 2016 Hewlett Packard Enterprise Development LP
+# All Rights Reserved.
+#
+#    Licensed under the Apache License, Version 2.0 (the "License"); you may
+#    not use this file except in compliance with the License. You may obtain
+#    a copy of the License at
+#
+#         http://www.apache.org/licenses/LICENSE-2.0
+#
+#    Unless required by applicable law or agreed to in writing, software
+#    distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+#    WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+#    License for the specific language governing permissions and limitations
+#    under the License.
+#
+##########################################################################
+# Description: Verify that ops-vland recovers the correct VLAN states when
+#              ovsdb-server is restarted while VLAN and port configuration
+#              keeps changing, that it skips ports that did not change, and
+#              that it recovers within RECOVERY_BOUND seconds.
+#
+# Topology:       |Switch|
+#
+# Success Criteria:  PASS -> After every restart all VLAN states match the
+#                            configuration within RECOVERY_BOUND seconds of
+#                            the last write
+#
+#                    FAILED -> A VLAN state is wrong or takes too long
+#                              to recover
+#
+##########################################################################
+
+"""
+OpenSwitch Test for ops-vland recovery after ovsdb-server restarts.
+"""
+
+from time import sleep, time
+
+
+TOPOLOGY = """
+# +-------+
+# |  ops1 |
+# +-------+
+
+# Nodes
+[type=openswitch name="OpenSwitch 1"] ops1
+"""
+
+VLANS = [str(vid) for vid in range(100, 140)]
+PORTS = ["1", "2", "3", "4"]
+# Ports whose configuration never changes, so that each reload after a
+# restart has ports that ops-vland can skip as unchanged.
+STABLE_PORTS = ["5", "6"]
+STABLE_TRUNKS = VLANS[:3]
+RESTARTS = 3
+RECOVERY_TIMEOUT = 30
+# Time allowed from the last write of the churn to correct VLAN states.
+RECOVERY_BOUND = 10
+CHURN_DONE = "/tmp/vland_restart_churn_done"
+
+
+def get_vlan_state(dut, vlanid):
+    out = dut("get vlan {vlanid} oper_state oper_state_reason".format(
+        **locals()
+    ), shell="vsctl")
+    lines = [line.strip().strip('"') for line in out.splitlines()]
+    return lines[0], lines[1]
+
+
+def get_vlan_uuid(dut, vlanid):
+    out = dut("ovs-vsctl --bare --columns=_uuid find vlan id={vlanid}".format(
+        **locals()
+    ), shell="bash")
+    return out.strip()
+
+
+def get_coverage(dut, counter):
+    out = dut("ovs-appctl -t ops-vland coverage/show", shell="bash")
+    for line in out.splitlines():
+        fields = line.split()
+        if fields and fields[0] == counter:
+            return int(fields[-1])
+    return 0
+
+
+def wait_for_vsctl(dut):
+    for i in range(RECOVERY_TIMEOUT * 2):
+        out = dut("ovs-vsctl --timeout=1 list-br", shell="bash")
+        if "bridge_normal" in out:
+            return
+        sleep(0.5)
+    assert False, "ovsdb-server did not come back"
+
+
+def wait_for_churn(dut):
+    for i in range(RECOVERY_TIMEOUT * 2):
+        out = dut("ls {}".format(CHURN_DONE), shell="bash")
+        if "No such file" not in out:
+            return
+        sleep(0.5)
+    assert False, "Churn did not finish"
+
+
+def port_trunks(i, restart):
+    first = (i + restart) % len(VLANS)
+    return VLANS[first:first + 5]
+
+
+def start_churn(dut, restart, uuids):
+    # Flip the admin state of every other VLAN and move the trunks of each
+    # port, so that the DB differs from what ops-vland saw last.  The writes
+    # run in the background and retry while ovsdb-server is down, so they
+    # land before, during and after the restart.
+    cmds = []
+    for i, vlan in enumerate(VLANS):
+        admin = "up" if (i + restart) % 2 == 0 else "down"
+        cmds.append("set vlan {vlan} admin={admin}".format(**locals()))
+    for i, port in enumerate(PORTS):
+        trunks = ",".join(uuids[vlan] for vlan in port_trunks(i, restart))
+        cmds.append("set port {port} vlan_mode=trunk "
+                    "vlan_trunks={trunks}".format(**locals()))
+    script = "; ".join(
+        "ovs-vsctl --retry --timeout={} {}".format(RECOVERY_TIMEOUT, cmd)
+        for cmd in cmds
+    )
+    dut("rm -f {}".format(CHURN_DONE), shell="bash")
+    dut("({}; touch {}) > /dev/null 2>&1 &".format(script, CHURN_DONE),
+        shell="bash")
+
+
+def expected_states(restart):
+    members = set(STABLE_TRUNKS)
+    for i in range(len(PORTS)):
+        members.update(port_trunks(i, restart))
+    states = {}
+    for i, vlan in enumerate(VLANS):
+        if (i + restart) % 2 != 0:
+            states[vlan] = ("down", "admin_down")
+        elif vlan not in members:
+            states[vlan] = ("down", "no_member_port")
+        else:
+            states[vlan] = ("up", "ok")
+    return states
+
+
+def wait_for_states(dut, states):
+    start = time()
+    pending = dict(states)
+    while pending and time() - start < RECOVERY_TIMEOUT:
+        for vlan in list(pending):
+            if get_vlan_state(dut, vlan) == pending[vlan]:
+                del pending[vlan]
+        if pending:
+            sleep(0.5)
+    assert not pending, "VLANs not recovered: {}".format(sorted(pending))
+    return time() - start
+
+
+def test_ft_vland_ovsdb_restart(topology, step):
+    ops1 = topology.get('ops1')
+
+    assert ops1 is not None
+
+    step("Step 1- Create vlans and trunk ports")
+    ops1("configure terminal")
+    for vlan in VLANS:
+        ops1("vlan {vlan}".format(**locals()))
+        ops1("no shutdown")
+        ops1("exit")
+    for port in PORTS + STABLE_PORTS:
+        ops1("interface {port}".format(**locals()))
+        ops1("no routing")
+        ops1("exit")
+    for port in STABLE_PORTS:
+        ops1("interface {port}".format(**locals()))
+        for vlan in STABLE_TRUNKS:
+            ops1("vlan trunk allowed {vlan}".format(**locals()))
+        ops1("exit")
+    ops1("end")
+
+    uuids = dict((vlan, get_vlan_uuid(ops1, vlan)) for vlan in VLANS)
+    start_churn(ops1, 0, uuids)
+    wait_for_churn(ops1)
+    wait_for_states(ops1, expected_states(0))
+
+    for restart in range(1, RESTARTS + 1):
+        step("Step {}- Restart ovsdb-server under churn".format(restart + 1))
+        unchanged_before = get_coverage(ops1, "vland_port_unchanged")
+
+        start_churn(ops1, restart, uuids)
+        ops1("systemctl restart ovsdb-server &", shell="bash")
+        wait_for_vsctl(ops1)
+        wait_for_churn(ops1)
+
+        elapsed = wait_for_states(ops1, expected_states(restart))
+        step("Recovered after restart {} in {:.2f}s".format(restart, elapsed))
+        assert elapsed < RECOVERY_BOUND, \
+            "Recovery took {:.2f}s".format(elapsed)
+
+        # The stable ports are reloaded with unchanged VLAN inputs and are
+        # not recomputed.
+        unchanged_after = get_coverage(ops1, "vland_port_unchanged")
+        assert unchanged_after > unchanged_before
+
+    step("Step {}- Remove configuration".format(RESTARTS + 2))
+    ops1("configure terminal")
+    for port in PORTS + STABLE_PORTS:
+        ops1("interface {port}".format(**locals()))
+        ops1("routing")
+        ops1("exit")
+    for vlan in VLANS:
+        ops1("no vlan {vlan}".format(**locals()))
+    ops1("end")
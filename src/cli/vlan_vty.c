@@ -30,6 +30,8 @@
 #include "vtysh/command.h"
 #include "vtysh/vty.h"
 #include "vtysh/vector.h"
+#include "bitmap.h"
+#include "vlan-bitmap.h"
 #include "vswitch-idl.h"
 #include "openswitch-idl.h"
 #include "openswitch-dflt.h"
@@ -68,6 +70,7 @@ compare_nodes_by_vlan_id_in_numerical(const void *a_, const void *b_)
 /*
  * Sorting function for vlan-id interface
  * on success, returns sorted vlan-id list.
+ * Deprecated: kept for other vtysh modules; this module does not use it.
  */
 const struct shash_node **
 sort_vlan_id(const struct shash *sh)
@@ -94,6 +97,326 @@ sort_vlan_id(const struct shash *sh)
     }
 }
 
+/*-----------------------------------------------------------------------------
+ | Function: vlan_range_parse
+ | Responsibility: Parse a VLAN ID range such as "2", "2-10", "2,3,4" or
+ |                 "2,3-10" into a bitmap of VLAN IDs.
+ | Parameters:
+ |      str: range to parse.
+ |      vids: bitmap of VLAN_BITMAP_SIZE bits, set to the IDs in the range.
+ | Return:
+ |      true if 'str' is a valid, non-empty range of IDs 1 to 4094.
+ ------------------------------------------------------------------------------
+ */
+static bool
+vlan_range_parse(const char *str, unsigned long *vids)
+{
+    const char *p = str;
+
+    memset(vids, 0, bitmap_n_bytes(VLAN_BITMAP_SIZE));
+    while (*p) {
+        char *end;
+        long min, max;
+
+        min = max = strtol(p, &end, 10);
+        if (end == p) {
+            return false;
+        }
+        if (*end == '-') {
+            p = end + 1;
+            max = strtol(p, &end, 10);
+            if (end == p) {
+                return false;
+            }
+        }
+        if (min < 1 || max > VLAN_BITMAP_SIZE - 2 || min > max) {
+            return false;
+        }
+        bitmap_set_multiple(vids, min, max - min + 1, true);
+
+        p = end;
+        if (*p == ',') {
+            p++;
+        } else if (*p) {
+            return false;
+        }
+    }
+
+    return !bitmap_is_all_zeros(vids, VLAN_BITMAP_SIZE);
+}
+
+/* Lookup tables over the IDL shared by the VLAN commands, so that a command
+ * need not scan whole tables to find a row by name or VLAN ID.  They are
+ * built on first use and rebuilt only when the IDL seqno changes, so a run
+ * of commands between two database updates builds them once.
+ *
+ * The tables hold the rows as of the last build.  A command must make its
+ * first lookup before it changes anything in its transaction, so that a
+ * rebuild never picks up rows that the transaction may yet abort.  Rows
+ * that the transaction inserts are therefore not in the tables. */
+static struct vlan_lookup {
+    bool valid;                     /* Built at least once. */
+    unsigned int seqno;             /* IDL seqno of the last build. */
+    struct shash ports;             /* Port rows by name. */
+    struct shash iface_ports;       /* Port rows by interface name. */
+    struct shash bridge_ports;      /* Port rows in a bridge, by name. */
+    const struct ovsrec_bridge *default_bridge;
+    const struct ovsrec_vlan *vlans[VLAN_BITMAP_SIZE];  /* VLAN rows by ID. */
+    unsigned long vlan_ids[BITMAP_N_LONGS(VLAN_BITMAP_SIZE)];
+    unsigned long internal[BITMAP_N_LONGS(VLAN_BITMAP_SIZE)]; /* L3 VLANs. */
+} vlan_lookup;
+
+/*-----------------------------------------------------------------------------
+ | Function: vlan_lookup_get
+ | Responsibility: Get the lookup tables, rebuilding them with one pass over
+ |                 each of the Port, Bridge and VLAN tables if the IDL has
+ |                 changed since they were last built.
+ | Return:
+ |      The lookup tables.
+ ------------------------------------------------------------------------------
+ */
+static const struct vlan_lookup *
+vlan_lookup_get(void)
+{
+    const struct ovsrec_port *port_row = NULL;
+    const struct ovsrec_bridge *bridge_row = NULL;
+    const struct ovsrec_vlan *vlan_row = NULL;
+    unsigned int seqno = ovsdb_idl_get_seqno(idl);
+    int i = 0;
+
+    if (vlan_lookup.valid && vlan_lookup.seqno == seqno)
+    {
+        return &vlan_lookup;
+    }
+
+    if (!vlan_lookup.valid)
+    {
+        shash_init(&vlan_lookup.ports);
+        shash_init(&vlan_lookup.iface_ports);
+        shash_init(&vlan_lookup.bridge_ports);
+    }
+    else
+    {
+        shash_clear(&vlan_lookup.ports);
+        shash_clear(&vlan_lookup.iface_ports);
+        shash_clear(&vlan_lookup.bridge_ports);
+    }
+    vlan_lookup.valid = true;
+    vlan_lookup.seqno = seqno;
+
+    OVSREC_PORT_FOR_EACH(port_row, idl)
+    {
+        shash_add_once(&vlan_lookup.ports, port_row->name, (void *)port_row);
+        for (i = 0; i < port_row->n_interfaces; i++)
+        {
+            shash_add_once(&vlan_lookup.iface_ports,
+                           port_row->interfaces[i]->name, (void *)port_row);
+        }
+    }
+
+    vlan_lookup.default_bridge = NULL;
+    OVSREC_BRIDGE_FOR_EACH(bridge_row, idl)
+    {
+        if (strcmp(bridge_row->name, DEFAULT_BRIDGE_NAME) == 0)
+        {
+            vlan_lookup.default_bridge = bridge_row;
+        }
+        for (i = 0; i < bridge_row->n_ports; i++)
+        {
+            shash_add_once(&vlan_lookup.bridge_ports,
+                           bridge_row->ports[i]->name,
+                           (void *)bridge_row->ports[i]);
+        }
+    }
+
+    memset(vlan_lookup.vlans, 0, sizeof vlan_lookup.vlans);
+    memset(vlan_lookup.vlan_ids, 0, sizeof vlan_lookup.vlan_ids);
+    memset(vlan_lookup.internal, 0, sizeof vlan_lookup.internal);
+    OVSREC_VLAN_FOR_EACH(vlan_row, idl)
+    {
+        if (vlan_row->id < 0 || vlan_row->id >= VLAN_BITMAP_SIZE)
+        {
+            continue;
+        }
+        vlan_lookup.vlans[vlan_row->id] = vlan_row;
+        bitmap_set1(vlan_lookup.vlan_ids, vlan_row->id);
+        if (smap_get(&vlan_row->internal_usage, VLAN_INTERNAL_USAGE_L3PORT))
+        {
+            bitmap_set1(vlan_lookup.internal, vlan_row->id);
+        }
+    }
+
+    return &vlan_lookup;
+}
+
+/* Returns the Port row named 'name', or NULL. */
+static const struct ovsrec_port *
+vlan_lookup_port(const char *name)
+{
+    return shash_find_data(&vlan_lookup_get()->ports, name);
+}
+
+/* Returns the Port row that has the interface named 'ifname', or NULL. */
+static const struct ovsrec_port *
+vlan_lookup_iface_port(const char *ifname)
+{
+    return shash_find_data(&vlan_lookup_get()->iface_ports, ifname);
+}
+
+/* Returns true if the port named 'name' is in a bridge, that is, it is not
+ * routed. */
+static bool
+vlan_lookup_port_in_bridge(const char *name)
+{
+    return shash_find(&vlan_lookup_get()->bridge_ports, name) != NULL;
+}
+
+/* Returns true if the port of the interface named 'ifname' is in a bridge.
+ * A port that is not in the lookup tables was created by the current
+ * transaction with port_check_and_add(), which attaches it to the default
+ * VRF; check_iface_in_bridge() reads it as the transaction has it. */
+static bool
+vlan_lookup_iface_in_bridge(const char *ifname)
+{
+    if (vlan_lookup_iface_port(ifname) == NULL)
+    {
+        return check_iface_in_bridge(ifname);
+    }
+    return vlan_lookup_port_in_bridge(ifname);
+}
+
+/* Returns the default bridge, or NULL. */
+static const struct ovsrec_bridge *
+vlan_lookup_default_bridge(void)
+{
+    return vlan_lookup_get()->default_bridge;
+}
+
+/* Returns the VLAN row with ID 'vid', or NULL. */
+static const struct ovsrec_vlan *
+vlan_lookup_vlan(long vid)
+{
+    if (vid < 0 || vid >= VLAN_BITMAP_SIZE)
+    {
+        return NULL;
+    }
+    return vlan_lookup_get()->vlans[vid];
+}
+
+/* Returns true if VLAN 'vid' exists and is used internally for an L3
+ * interface. */
+static bool
+vlan_lookup_is_internal(long vid)
+{
+    return (vid >= 0 && vid < VLAN_BITMAP_SIZE
+            && bitmap_is_set(vlan_lookup_get()->internal, vid));
+}
+
+/*-----------------------------------------------------------------------------
+ | Function: vlan_port_add_trunks
+ | Responsibility: Add a set of VLANs to the trunks of a port, with a single
+ |                 write of the trunks column.  The current trunks keep their
+ |                 order and the new VLANs are appended in ID order.
+ | Parameters:
+ |      port_row: port to update.
+ |      vids: bitmap of VLAN_BITMAP_SIZE bits of the VLAN IDs to add.
+ |      already: bitmap of VLAN_BITMAP_SIZE bits, set to the IDs in 'vids'
+ |               that the port already trunks.
+ | Return:
+ |      The number of VLANs added.
+ ------------------------------------------------------------------------------
+ */
+static size_t
+vlan_port_add_trunks(const struct ovsrec_port *port_row,
+                     const unsigned long *vids, unsigned long *already)
+{
+    int64_t *trunks = NULL;
+    size_t n_trunks = 0;
+    int vlan_id = 0;
+    int i = 0;
+
+    memset(already, 0, bitmap_n_bytes(VLAN_BITMAP_SIZE));
+    trunks = xmalloc(sizeof(int64_t) * (port_row->n_vlan_trunks
+                                        + bitmap_count1(vids, VLAN_BITMAP_SIZE)));
+    for (i = 0; i < port_row->n_vlan_trunks; i++)
+    {
+        int64_t trunk = ops_port_get_trunks(port_row, i);
+
+        trunks[n_trunks++] = trunk;
+        if (trunk >= 0 && trunk < VLAN_BITMAP_SIZE
+            && bitmap_is_set(vids, trunk))
+        {
+            bitmap_set1(already, trunk);
+        }
+    }
+
+    BITMAP_FOR_EACH_1(vlan_id, VLAN_BITMAP_SIZE, vids)
+    {
+        if (!bitmap_is_set(already, vlan_id))
+        {
+            trunks[n_trunks++] = vlan_id;
+        }
+    }
+
+    if (n_trunks > port_row->n_vlan_trunks)
+    {
+        ops_port_set_trunks(trunks, n_trunks, port_row, idl);
+    }
+    free(trunks);
+
+    return n_trunks - port_row->n_vlan_trunks;
+}
+
+/*-----------------------------------------------------------------------------
+ | Function: vlan_port_prune_trunks
+ | Responsibility: Remove a set of VLANs from the trunks of a port, with a
+ |                 single write of the trunks column.
+ | Parameters:
+ |      port_row: port to update.
+ |      vids: bitmap of VLAN_BITMAP_SIZE bits of the VLAN IDs to remove.
+ |      n_left: set to the number of trunks the port is left with.
+ | Return:
+ |      true if any trunk was removed, false if the port trunks none of the
+ |      VLANs in 'vids', in which case it is left unchanged.
+ ------------------------------------------------------------------------------
+ */
+static bool
+vlan_port_prune_trunks(const struct ovsrec_port *port_row,
+                       const unsigned long *vids, size_t *n_left)
+{
+    int64_t *trunks = NULL;
+    size_t n = 0;
+    int i = 0;
+
+    *n_left = port_row->n_vlan_trunks;
+    if (port_row->n_vlan_trunks == 0)
+    {
+        return false;
+    }
+
+    trunks = xmalloc(sizeof(int64_t) * port_row->n_vlan_trunks);
+    for (i = 0; i < port_row->n_vlan_trunks; i++)
+    {
+        int64_t trunk = ops_port_get_trunks(port_row, i);
+
+        if (trunk < 1 || trunk >= VLAN_BITMAP_SIZE
+            || !bitmap_is_set(vids, trunk))
+        {
+            trunks[n++] = trunk;
+        }
+    }
+
+    if (n == port_row->n_vlan_trunks)
+    {
+        free(trunks);
+        return false;
+    }
+
+    ops_port_set_trunks(trunks, n, port_row, idl);
+    free(trunks);
+    *n_left = n;
+    return true;
+}
 
 /*-----------------------------------------------------------------------------
  | Function: vlan_int_range_add
@@ -190,20 +513,18 @@ DEFUN (vtysh_interface_vlan,
        return CMD_ERR_NOTHING_TODO;
    }
 
-   OVSREC_VLAN_FOR_EACH(vlan_row, idl)
+   vlan_row = vlan_lookup_vlan(vlan_id);
+   if (vlan_row != NULL)
    {
-       if (vlan_row->id == vlan_id)
-       {
-           if (create_vlan_interface(vlan_if) == CMD_OVSDB_FAILURE) {
-               vty->node = CONFIG_NODE;
-               return CMD_ERR_NOTHING_TODO;
-           }
+       if (create_vlan_interface(vlan_if) == CMD_OVSDB_FAILURE) {
+           vty->node = CONFIG_NODE;
+           return CMD_ERR_NOTHING_TODO;
+       }
 
-           VLOG_DBG("%s Created vlan interface = %s\n", __func__, vlan_if);
+       VLOG_DBG("%s Created vlan interface = %s\n", __func__, vlan_if);
 
-           vty->index = vlan_if;
-           return CMD_SUCCESS;
-       }
+       vty->index = vlan_if;
+       return CMD_SUCCESS;
    }
 
    vty_out(vty, "VLAN %d should be created before creating "
@@ -239,14 +560,138 @@ DEFUN (no_vtysh_interface_vlan,
    return CMD_SUCCESS;
 }
 
+/*-----------------------------------------------------------------------------
+ | Function: vlan_range_create
+ | Responsibility: Create every VLAN of a range that does not exist yet, in a
+ |                 single transaction.  The default bridge's VLANs are
+ |                 updated once, and the VLAN interfaces of the new VLANs
+ |                 are found in a single pass over the ports.
+ | Parameters:
+ |      vty: terminal to report errors on.
+ |      range: VLAN ID range, e.g. "2-100" or "10,20-30".
+ | Return:
+ |      CMD_SUCCESS - Config executed successfully.
+ |      CMD_ERR_NO_MATCH - 'range' is not a valid range.
+ ------------------------------------------------------------------------------
+ */
+static int
+vlan_range_create(struct vty *vty, const char *range)
+{
+    const struct vlan_lookup *lookup = NULL;
+    const struct ovsrec_vlan *vlan_row = NULL;
+    const struct ovsrec_bridge *default_bridge_row = NULL;
+    const struct ovsrec_port *port_row = NULL;
+    struct ovsdb_idl_txn *status_txn = NULL;
+    enum ovsdb_idl_txn_status status;
+    struct ovsrec_vlan **vlans = NULL;
+    unsigned long vids[BITMAP_N_LONGS(VLAN_BITMAP_SIZE)];
+    size_t n_vlans = 0;
+    char vlan_name[9];
+    char vid_str[12];
+    char vlan_if[MAX_IFNAME_LENGTH];
+    int vlan_id = 0;
+    int i = 0;
+
+    if (!vlan_range_parse(range, vids))
+    {
+        return CMD_ERR_NO_MATCH;
+    }
+
+    /* Leave out the VLANs that exist already. */
+    lookup = vlan_lookup_get();
+    BITMAP_FOR_EACH_1(vlan_id, VLAN_BITMAP_SIZE, lookup->vlan_ids)
+    {
+        if (vlan_id < 1 || !bitmap_is_set(vids, vlan_id))
+        {
+            continue;
+        }
+        if (bitmap_is_set(lookup->internal, vlan_id))
+        {
+            /* Check for internal VLAN.
+             * No configuration is allowed on internal VLANs. */
+            vty_out(vty, "VLAN%d is used as an internal VLAN. "
+                    "No further configuration allowed.%s", vlan_id, VTY_NEWLINE);
+        }
+        bitmap_set0(vids, vlan_id);
+    }
+
+    if (bitmap_is_all_zeros(vids, VLAN_BITMAP_SIZE))
+    {
+        return CMD_SUCCESS;
+    }
+
+    status_txn = cli_do_config_start();
+    if (status_txn == NULL)
+    {
+        VLOG_DBG("Transaction creation failed by cli_do_config_start().Function=%s, Line=%d", __func__, __LINE__);
+        cli_do_config_abort(status_txn);
+        vty_out(vty, "Failed to create the vlan%s", VTY_NEWLINE);
+        return CMD_SUCCESS;
+    }
+
+    default_bridge_row = lookup->default_bridge;
+    if (default_bridge_row == NULL)
+    {
+        VLOG_DBG("Couldn't find default bridge. Function=%s, Line=%d", __func__, __LINE__);
+        cli_do_config_abort(status_txn);
+        vty_out(vty, "Failed to create the vlan%s", VTY_NEWLINE);
+        return CMD_SUCCESS;
+    }
+
+    vlans = xmalloc(sizeof(*default_bridge_row->vlans) *
+        (default_bridge_row->n_vlans + bitmap_count1(vids, VLAN_BITMAP_SIZE)));
+    for (i = 0; i < default_bridge_row->n_vlans; i++)
+    {
+        vlans[n_vlans++] = default_bridge_row->vlans[i];
+    }
+
+    BITMAP_FOR_EACH_1(vlan_id, VLAN_BITMAP_SIZE, vids)
+    {
+        snprintf(vlan_name, sizeof vlan_name, "%s%d", "VLAN", vlan_id);
+        vlan_row = ovsrec_vlan_insert(status_txn);
+        ovsrec_vlan_set_id(vlan_row, vlan_id);
+        ovsrec_vlan_set_name(vlan_row, vlan_name);
+        ovsrec_vlan_set_admin(vlan_row, OVSREC_VLAN_ADMIN_DOWN);
+        ovsrec_vlan_set_oper_state(vlan_row, OVSREC_VLAN_OPER_STATE_DOWN);
+        ovsrec_vlan_set_oper_state_reason(vlan_row, OVSREC_VLAN_OPER_STATE_REASON_ADMIN_DOWN);
+        vlans[n_vlans++] = CONST_CAST(struct ovsrec_vlan*, vlan_row);
+    }
+    ovsrec_bridge_set_vlans(default_bridge_row, vlans, n_vlans);
+    free(vlans);
+
+    /* Checking for interface vlans, if found add as members of their vlans.*/
+    BITMAP_FOR_EACH_1(vlan_id, VLAN_BITMAP_SIZE, vids)
+    {
+        snprintf(vid_str, sizeof vid_str, "%d", vlan_id);
+        VLANIF_NAME(vlan_if, vid_str);
+        port_row = vlan_lookup_port(vlan_if);
+        if (port_row != NULL)
+        {
+            ops_port_set_tag(vlan_id, port_row, idl);
+            ovsrec_port_set_vlan_mode(port_row, NULL);
+        }
+    }
+
+    status = cli_do_config_finish(status_txn);
+    if (status == TXN_SUCCESS || status == TXN_UNCHANGED)
+    {
+        return CMD_SUCCESS;
+    }
+    else
+    {
+        VLOG_DBG("Transaction failed to create vlan. Function:%s, LINE:%d", __func__, __LINE__);
+        vty_out(vty, "Failed to create the vlan%s", VTY_NEWLINE);
+        return CMD_SUCCESS;
+    }
+}
+
 DEFUN(vtysh_vlan,
     vtysh_vlan_cmd,
-    "vlan <1-4094>",
+    "vlan <A:1-4094>",
     VLAN_STR
-    "VLAN identifier\n")
+    "VLAN identifier, or range of VLANs to create. [2, 2-10 or 2,3,4 or 2,3-10]\n")
 {
     const struct ovsrec_vlan *vlan_row = NULL;
-    const struct ovsrec_bridge *bridge_row = NULL;
     const struct ovsrec_bridge *default_bridge_row = NULL;
     const struct ovsrec_port *port_row = NULL;
     bool vlan_found = false;
@@ -258,22 +703,19 @@ DEFUN(vtysh_vlan,
     static char vlan[5] = { 0 };
     static char vlan_name[9] = { 0 };
     static char vlan_if[MAX_IFNAME_LENGTH];
-    snprintf(vlan, 5, "%s", argv[0]);
-    snprintf(vlan_name, 9, "%s%s", "VLAN", argv[0]);
 
-    vlan_row = ovsrec_vlan_first(idl);
-    if (vlan_row != NULL)
+    /* A range creates its VLANs without entering the VLAN context. */
+    if (strpbrk(argv[0], ",-"))
     {
-        OVSREC_VLAN_FOR_EACH(vlan_row, idl)
-        {
-            if (vlan_row->id == vlan_id)
-            {
-                vlan_found = true;
-                break;
-            }
-        }
+        return vlan_range_create(vty, argv[0]);
     }
 
+    snprintf(vlan, 5, "%s", argv[0]);
+    snprintf(vlan_name, 9, "%s%s", "VLAN", argv[0]);
+
+    vlan_row = vlan_lookup_vlan(vlan_id);
+    vlan_found = (vlan_row != NULL);
+
     if (vlan_found && check_if_internal_vlan(vlan_row))
     {
         /* Check for internal VLAN.
@@ -295,6 +737,15 @@ DEFUN(vtysh_vlan,
             return CMD_SUCCESS;
         }
 
+        default_bridge_row = vlan_lookup_default_bridge();
+        if (default_bridge_row == NULL)
+        {
+            VLOG_DBG("Couldn't find default bridge. Function=%s, Line=%d", __func__, __LINE__);
+            cli_do_config_abort(status_txn);
+            vty_out(vty, "Failed to create the vlan%s", VTY_NEWLINE);
+            return CMD_SUCCESS;
+        }
+
         vlan_row = ovsrec_vlan_insert(status_txn);
         ovsrec_vlan_set_id(vlan_row, vlan_id);
         ovsrec_vlan_set_name(vlan_row, vlan_name);
@@ -302,27 +753,6 @@ DEFUN(vtysh_vlan,
         ovsrec_vlan_set_oper_state(vlan_row, OVSREC_VLAN_OPER_STATE_DOWN);
         ovsrec_vlan_set_oper_state_reason(vlan_row, OVSREC_VLAN_OPER_STATE_REASON_ADMIN_DOWN);
 
-        default_bridge_row = ovsrec_bridge_first(idl);
-        if (default_bridge_row != NULL)
-        {
-            OVSREC_BRIDGE_FOR_EACH(bridge_row, idl)
-            {
-                if (strcmp(bridge_row->name, DEFAULT_BRIDGE_NAME) == 0)
-                {
-                    default_bridge_row = (struct ovsrec_bridge*)bridge_row;
-                    break;
-                }
-            }
-
-            if (default_bridge_row == NULL)
-            {
-                VLOG_DBG("Couldn't find default bridge. Function=%s, Line=%d", __func__, __LINE__);
-                cli_do_config_abort(status_txn);
-                vty_out(vty, "Failed to create the vlan%s", VTY_NEWLINE);
-                return CMD_SUCCESS;
-            }
-        }
-
         vlans = xmalloc(sizeof(*default_bridge_row->vlans) *
             (default_bridge_row->n_vlans + 1));
         for (i = 0; i < default_bridge_row->n_vlans; i++)
@@ -334,12 +764,10 @@ DEFUN(vtysh_vlan,
             default_bridge_row->n_vlans + 1);
         /* Checking for interface vlan if found add as a member of the vlan.*/
         VLANIF_NAME(vlan_if, argv[0]);
-        OVSREC_PORT_FOR_EACH(port_row, idl)
-        {
-           if (strcmp(port_row->name, vlan_if) == 0) {
-               ops_port_set_tag(vlan_id, port_row, idl);
-               ovsrec_port_set_vlan_mode(port_row, NULL);
-           }
+        port_row = vlan_lookup_port(vlan_if);
+        if (port_row != NULL) {
+            ops_port_set_tag(vlan_id, port_row, idl);
+            ovsrec_port_set_vlan_mode(port_row, NULL);
         }
 
 
@@ -350,33 +778,241 @@ DEFUN(vtysh_vlan,
             vty->node = VLAN_NODE;
             vty->index = (char *) vlan;
         }
-        else
+        else
+        {
+            VLOG_DBG("Transaction failed to create vlan. Function:%s, LINE:%d", __func__, __LINE__);
+            vty_out(vty, "Failed to create the vlan%s", VTY_NEWLINE);
+            return CMD_SUCCESS;
+        }
+    }
+    else
+    {
+        vty->node = VLAN_NODE;
+        vty->index = (char *) vlan;
+        return CMD_SUCCESS;
+    }
+    return CMD_SUCCESS;
+}
+
+/*-----------------------------------------------------------------------------
+ | Function: vlan_range_delete
+ | Responsibility: Delete every VLAN of a range in a single transaction.
+ |                 The restrictions on internal and interface VLANs are
+ |                 checked for the whole range first; if any VLAN of the
+ |                 range may not be deleted, none is.  Then the default
+ |                 bridge's VLANs are updated once, and each port that uses
+ |                 a deleted VLAN has its trunks and tag rewritten once.
+ | Parameters:
+ |      vty: terminal to report errors on.
+ |      range: VLAN ID range, e.g. "2-100" or "10,20-30".
+ | Return:
+ |      CMD_SUCCESS - Config executed successfully.
+ |      CMD_ERR_NO_MATCH - 'range' is not a valid range, or it includes
+ |                         the default VLAN.
+ |      CMD_ERR_NOTHING_TODO - A VLAN of the range is an interface VLAN.
+ ------------------------------------------------------------------------------
+ */
+static int
+vlan_range_delete(struct vty *vty, const char *range)
+{
+    const struct vlan_lookup *lookup = NULL;
+    const struct ovsrec_port *port_row = NULL;
+    const struct ovsrec_bridge *default_bridge_row = NULL;
+    struct ovsdb_idl_txn *status_txn = NULL;
+    enum ovsdb_idl_txn_status status;
+    struct ovsrec_vlan **vlans = NULL;
+    unsigned long vids[BITMAP_N_LONGS(VLAN_BITMAP_SIZE)];
+    unsigned long found[BITMAP_N_LONGS(VLAN_BITMAP_SIZE)];
+    int64_t *trunks = NULL;
+    bool internal_found = false;
+    bool intf_vlan_found = false;
+    char vid_str[12];
+    char vlan_if[MAX_IFNAME_LENGTH];
+    int vlan_id = 0;
+    int i = 0, n = 0;
+
+    /* The command takes VLAN IDs from 2 on, as "no vlan <A:2-4094>" does
+     * for a single VLAN; the default VLAN can never be deleted. */
+    if (!vlan_range_parse(range, vids) || bitmap_is_set(vids, DEFAULT_VLAN))
+    {
+        return CMD_ERR_NO_MATCH;
+    }
+
+    /* Find the VLANs of the range, and check for internal VLANs. */
+    lookup = vlan_lookup_get();
+    memset(found, 0, sizeof found);
+    BITMAP_FOR_EACH_1(vlan_id, VLAN_BITMAP_SIZE, lookup->vlan_ids)
+    {
+        if (vlan_id < 1 || !bitmap_is_set(vids, vlan_id))
+        {
+            continue;
+        }
+        bitmap_set1(found, vlan_id);
+        if (bitmap_is_set(lookup->internal, vlan_id))
+        {
+            /* Check for internal VLAN.
+             * No deletion is allowed on internal VLANs. */
+            vty_out(vty, "VLAN%d is used as an internal VLAN. "
+                    "Deletion not allowed.%s", vlan_id, VTY_NEWLINE);
+            internal_found = true;
+        }
+    }
+
+    if (internal_found)
+    {
+        return CMD_SUCCESS;
+    }
+
+    BITMAP_FOR_EACH_1(vlan_id, VLAN_BITMAP_SIZE, vids)
+    {
+        if (!bitmap_is_set(found, vlan_id))
+        {
+            vty_out(vty, "Couldn't find the VLAN %d. Make sure it's configured%s", vlan_id, VTY_NEWLINE);
+        }
+    }
+    if (bitmap_is_all_zeros(found, VLAN_BITMAP_SIZE))
+    {
+        return CMD_SUCCESS;
+    }
+
+    /* Check for inteface VLANs.
+     * L2 VLAN deletion is allowed if interface VLAN exists */
+    BITMAP_FOR_EACH_1(vlan_id, VLAN_BITMAP_SIZE, found)
+    {
+        snprintf(vid_str, sizeof vid_str, "%d", vlan_id);
+        VLANIF_NAME(vlan_if, vid_str);
+        if (vlan_lookup_port(vlan_if) != NULL)
+        {
+            vty_out(vty, "VLAN%d is used as an interface VLAN. "
+                    "Deletion not allowed.%s", vlan_id, VTY_NEWLINE);
+            intf_vlan_found = true;
+        }
+    }
+
+    if (intf_vlan_found)
+    {
+        vty->node = CONFIG_NODE;
+        return CMD_ERR_NOTHING_TODO;
+    }
+
+    status_txn = cli_do_config_start();
+    if (status_txn == NULL)
+    {
+        VLOG_DBG("Trasaction creation failed by cli_do_config_start().Function=%s, Line=%d", __func__, __LINE__);
+        cli_do_config_abort(status_txn);
+        vty_out(vty, "Failed to create the vlan%s", VTY_NEWLINE);
+        return CMD_SUCCESS;
+    }
+
+    default_bridge_row = lookup->default_bridge;
+    if (default_bridge_row == NULL)
+    {
+        VLOG_DBG("Couldn't find default bridge. Function=%s, Line=%d", __func__, __LINE__);
+        cli_do_config_abort(status_txn);
+        vty_out(vty, "Failed to create the vlan%s", VTY_NEWLINE);
+        return CMD_SUCCESS;
+    }
+
+    vlans = xmalloc(sizeof(*default_bridge_row->vlans) *
+        (default_bridge_row->n_vlans + 1));
+    for (i = n = 0; i < default_bridge_row->n_vlans; i++)
+    {
+        vlan_id = default_bridge_row->vlans[i]->id;
+        if (vlan_id < 1 || vlan_id >= VLAN_BITMAP_SIZE
+            || !bitmap_is_set(found, vlan_id))
+        {
+            vlans[n++] = default_bridge_row->vlans[i];
+        }
+    }
+    ovsrec_bridge_set_vlans(default_bridge_row, vlans, n);
+    free(vlans);
+
+    OVSREC_PORT_FOR_EACH(port_row, idl)
+    {
+        bool vlan_found = false;
+        int trunk_count = 0;
+
+        trunks = xrealloc(trunks, sizeof(int64_t) * (port_row->n_vlan_trunks + 1));
+        for (i = 0; i < port_row->n_vlan_trunks; i++)
+        {
+            int64_t trunk = ops_port_get_trunks(port_row, i);
+
+            if (trunk >= 1 && trunk < VLAN_BITMAP_SIZE
+                && bitmap_is_set(found, trunk))
+            {
+                vlan_found = true;
+            }
+            else
+            {
+                trunks[trunk_count++] = trunk;
+            }
+        }
+        if (vlan_found)
+        {
+            ops_port_set_trunks(trunks, trunk_count, port_row, idl);
+        }
+
+        if (port_row->vlan_tag != NULL)
+        {
+            vlan_id = ops_port_get_tag(port_row);
+            if (vlan_id >= 1 && vlan_id < VLAN_BITMAP_SIZE
+                && bitmap_is_set(found, vlan_id))
+            {
+                vlan_found = true;
+            }
+        }
+
+        if (vlan_found)
         {
-            VLOG_DBG("Transaction failed to create vlan. Function:%s, LINE:%d", __func__, __LINE__);
-            vty_out(vty, "Failed to create the vlan%s", VTY_NEWLINE);
-            return CMD_SUCCESS;
+            if ( trunk_count ) {
+                ovsrec_port_set_vlan_mode(port_row, OVSREC_PORT_VLAN_MODE_TRUNK);
+                ops_port_set_tag(0, port_row, idl);
+            } else {
+                /* The port's own interface, if it is not a LAG or VLAN
+                 * interface. */
+                for (i = 0; i < port_row->n_interfaces; i++) {
+                    const struct ovsrec_interface *ifrow = port_row->interfaces[i];
+
+                    if (strcmp(ifrow->name, port_row->name) == 0 &&
+                        strcmp(ifrow->type, OVSREC_INTERFACE_TYPE_SYSTEM) == 0) {
+                        ovsrec_port_set_vlan_mode(port_row, OVSREC_PORT_VLAN_MODE_ACCESS);
+                        ops_port_set_tag(DEFAULT_VLAN, port_row, idl);
+                        break;
+                    }
+                }
+            }
         }
     }
+    free(trunks);
+
+    BITMAP_FOR_EACH_1(vlan_id, VLAN_BITMAP_SIZE, found)
+    {
+        ovsrec_vlan_delete(lookup->vlans[vlan_id]);
+    }
+
+    status = cli_do_config_finish(status_txn);
+    if (status == TXN_SUCCESS || status == TXN_UNCHANGED)
+    {
+        return CMD_SUCCESS;
+    }
     else
     {
-        vty->node = VLAN_NODE;
-        vty->index = (char *) vlan;
+        VLOG_DBG("Transaction failed to delete vlan. Function:%s, LINE:%d", __func__, __LINE__);
+        vty_out(vty, "Failed to delete the vlan%s", VTY_NEWLINE);
         return CMD_SUCCESS;
     }
-    return CMD_SUCCESS;
 }
 
 DEFUN(vtysh_no_vlan,
     vtysh_no_vlan_cmd,
-    "no vlan <2-4094>",
+    "no vlan <A:2-4094>",
     NO_STR
     VLAN_STR
-    "VLAN Identifier\n")
+    "VLAN Identifier, or range of VLANs to delete. [2, 2-10 or 2,3,4 or 2,3-10]\n")
 {
     const struct ovsrec_vlan *vlan_row = NULL;
     const struct ovsrec_port *port_row = NULL;
     const struct ovsrec_interface *ifrow= NULL;
-    const struct ovsrec_bridge *bridge_row = NULL;
     const struct ovsrec_bridge *default_bridge_row = NULL;
     bool vlan_found = false;
     struct ovsdb_idl_txn *status_txn = NULL;
@@ -386,19 +1022,14 @@ DEFUN(vtysh_no_vlan,
     int vlan_id = atoi(argv[0]);
     static char vlan_if[MAX_IFNAME_LENGTH];
 
-    vlan_row = ovsrec_vlan_first(idl);
-    if (vlan_row != NULL)
+    if (strpbrk(argv[0], ",-"))
     {
-        OVSREC_VLAN_FOR_EACH(vlan_row, idl)
-        {
-            if (vlan_row->id == vlan_id)
-            {
-                vlan_found = true;
-                break;
-            }
-        }
+        return vlan_range_delete(vty, argv[0]);
     }
 
+    vlan_row = vlan_lookup_vlan(vlan_id);
+    vlan_found = (vlan_row != NULL);
+
     if (vlan_found)
     {
         if (check_if_internal_vlan(vlan_row))
@@ -412,7 +1043,7 @@ DEFUN(vtysh_no_vlan,
 
         VLANIF_NAME(vlan_if, argv[0]);
 
-        if (!vtysh_ovsdb_port_match(vlan_if))
+        if (vlan_lookup_port(vlan_if) != NULL)
         {
             /* Check for inteface VLAN.
              * L2 VLAN deletion is allowed if interface VLAN exists */
@@ -432,25 +1063,13 @@ DEFUN(vtysh_no_vlan,
             return CMD_SUCCESS;
         }
 
-        default_bridge_row = ovsrec_bridge_first(idl);
-        if (default_bridge_row != NULL)
+        default_bridge_row = vlan_lookup_default_bridge();
+        if (default_bridge_row == NULL)
         {
-            OVSREC_BRIDGE_FOR_EACH(bridge_row, idl)
-            {
-                if (strcmp(bridge_row->name, DEFAULT_BRIDGE_NAME) == 0)
-                {
-                    default_bridge_row = (struct ovsrec_bridge*)bridge_row;
-                    break;
-                }
-            }
-
-            if (default_bridge_row == NULL)
-            {
-                VLOG_DBG("Couldn't find default bridge. Function=%s, Line=%d", __func__, __LINE__);
-                cli_do_config_abort(status_txn);
-                vty_out(vty, "Failed to create the vlan%s", VTY_NEWLINE);
-                return CMD_SUCCESS;
-            }
+            VLOG_DBG("Couldn't find default bridge. Function=%s, Line=%d", __func__, __LINE__);
+            cli_do_config_abort(status_txn);
+            vty_out(vty, "Failed to create the vlan%s", VTY_NEWLINE);
+            return CMD_SUCCESS;
         }
 
         vlans = xmalloc(sizeof(*default_bridge_row->vlans) *
@@ -707,6 +1326,24 @@ DEFUN  (cli_vlan_int_range_del_arg,
 }
 
 
+/* A port and its internal VLAN ID, parsed once for sorting. */
+struct port_by_vid {
+    int vid;
+    const struct ovsrec_port *port;
+};
+
+/* qsort comparator: orders ports by internal VLAN ID, then by name. */
+static int
+compare_ports_by_vid(const void *a_, const void *b_)
+{
+    const struct port_by_vid *a = a_;
+    const struct port_by_vid *b = b_;
+
+    if (a->vid != b->vid)
+        return a->vid < b->vid ? -1 : 1;
+    return strcmp(a->port->name, b->port->name);
+}
+
 /*-----------------------------------------------------------------------------
  | Function: show_vlan_int_range
  | Responsibility: Handle 'show vlan internal' command
@@ -722,9 +1359,10 @@ static int show_vlan_int_range()
     const char *policy;
     uint16_t   min_vlan, max_vlan;
 
-    struct shash sorted_vlan_port;
-    const struct shash_node **nodes;
-    int idx, count;
+    struct port_by_vid *ports = NULL;
+    size_t n_ports = 0;
+    size_t allocated = 0;
+    size_t i;
 
     /* VLAN info on port */
     const struct ovsrec_port *port_row = NULL;
@@ -768,28 +1406,30 @@ static int show_vlan_int_range()
     vty_out(vty, "\t%-4s\t\t%-16s\n", "VLAN","Interface");
     vty_out(vty, "\t%-4s\t\t%-16s\n", "----","---------");
 
-    shash_init(&sorted_vlan_port);
-
     OVSREC_PORT_FOR_EACH(port_row, idl) {
         port_vlan_str = smap_get(&port_row->hw_config, PORT_HW_CONFIG_MAP_INTERNAL_VLAN_ID);
 
         if (port_vlan_str == NULL) {
             continue;
         } else {
-            shash_add(&sorted_vlan_port, port_vlan_str, (void *)port_row);
+            if (n_ports >= allocated) {
+                ports = x2nrealloc(ports, &allocated, sizeof *ports);
+            }
+            ports[n_ports].vid = atoi(port_vlan_str);
+            ports[n_ports].port = port_row;
+            n_ports++;
         }
     }
 
-    count = shash_count(&sorted_vlan_port);
-    nodes = sort_vlan_id(&sorted_vlan_port);
-    for (idx = 0; idx < count; idx++) {
-        port_row = (const struct ovsrec_port *)nodes[idx]->data;
-         port_vlan_str = smap_get(&port_row->hw_config, PORT_HW_CONFIG_MAP_INTERNAL_VLAN_ID);
+    /* Every port is listed, even if two share an internal VLAN ID. */
+    qsort(ports, n_ports, sizeof *ports, compare_ports_by_vid);
+    for (i = 0; i < n_ports; i++) {
+        port_row = ports[i].port;
+        port_vlan_str = smap_get(&port_row->hw_config, PORT_HW_CONFIG_MAP_INTERNAL_VLAN_ID);
         vty_out(vty, "\t%-4s\t\t%-16s\n", port_vlan_str, port_row->name);
     }
 
-    shash_destroy(&sorted_vlan_port);
-    free(nodes);
+    free(ports);
 
     return CMD_SUCCESS;
 }
@@ -833,13 +1473,7 @@ DEFUN(cli_vlan_admin,
 
     }
 
-    OVSREC_VLAN_FOR_EACH(vlan_row, idl)
-    {
-        if (vlan_row->id == vlan_id)
-        {
-            break;
-        }
-    }
+    vlan_row = vlan_lookup_vlan(vlan_id);
 
     ovsrec_vlan_set_admin(vlan_row, OVSREC_VLAN_ADMIN_DOWN);
     status = cli_do_config_finish(status_txn);
@@ -875,13 +1509,7 @@ DEFUN(cli_no_vlan_admin,
         return CMD_SUCCESS;
     }
 
-    OVSREC_VLAN_FOR_EACH(vlan_row, idl)
-    {
-        if (vlan_row->id == vlan_id)
-        {
-            break;
-        }
-    }
+    vlan_row = vlan_lookup_vlan(vlan_id);
 
     ovsrec_vlan_set_admin(vlan_row, OVSREC_VLAN_ADMIN_UP);
     status = cli_do_config_finish(status_txn);
@@ -904,15 +1532,12 @@ DEFUN(cli_intf_vlan_access,
     "Access configuration\n"
     "VLAN identifier\n")
 {
-    const struct ovsrec_port *port_row = NULL;
-    const struct ovsrec_interface * tmp_row = NULL;
     const struct ovsrec_port *vlan_port_row = NULL;
-    const struct ovsrec_interface *intf_row = NULL;
     const struct ovsrec_vlan *vlan_row = NULL;
     struct ovsdb_idl_txn *status_txn = cli_do_config_start();
     enum ovsdb_idl_txn_status status;
     int vlan_id = atoi((char *) argv[0]);
-    int i = 0, found_vlan = 0;
+    int found_vlan = 0;
 
     if (NULL == status_txn)
     {
@@ -923,52 +1548,21 @@ DEFUN(cli_intf_vlan_access,
     }
 
     /* Check for internal vlan use. */
-    OVSREC_INTERFACE_FOR_EACH(tmp_row, idl) {
-        if (check_internal_vlan(atoi(argv[0])) == 0)
-        {
-            vty_out(vty, "Error : Vlan ID is an internal vlan.%s", VTY_NEWLINE);
-	    cli_do_config_abort(status_txn);
-            return CMD_SUCCESS;
-        }
+    if (vlan_lookup_is_internal(atoi(argv[0])))
+    {
+        vty_out(vty, "Error : Vlan ID is an internal vlan.%s", VTY_NEWLINE);
+        cli_do_config_abort(status_txn);
+        return CMD_SUCCESS;
     }
 
     char *ifname = (char *) vty->index;
 
-    OVSREC_INTERFACE_FOR_EACH(intf_row, idl)
-    {
-        if (strcmp(intf_row->name, ifname) == 0)
-        {
-            break;
-        }
-    }
-
-    port_row = ovsrec_port_first(idl);
-    if (NULL == port_row)
-    {
-        vlan_port_row = port_check_and_add(ifname, true, true, status_txn);
-    }
-    else
+    vlan_port_row = vlan_lookup_iface_port(ifname);
+    if (vlan_port_row != NULL && strcmp(vlan_port_row->name, ifname) != 0)
     {
-        OVSREC_PORT_FOR_EACH(port_row, idl)
-        {
-            for (i = 0; i < port_row->n_interfaces; i++)
-            {
-                if (port_row->interfaces[i] == intf_row)
-                {
-                    if (strcmp(port_row->name, ifname) != 0)
-                    {
-                        vty_out(vty, "Can't configure VLAN, interface is part of LAG %s.%s", port_row->name, VTY_NEWLINE);
-                        cli_do_config_abort(status_txn);
-                        return CMD_SUCCESS;
-                    }
-                    else
-                    {
-                        vlan_port_row = port_row;
-                        break;
-                    }
-                }
-            }
-        }
+        vty_out(vty, "Can't configure VLAN, interface is part of LAG %s.%s", vlan_port_row->name, VTY_NEWLINE);
+        cli_do_config_abort(status_txn);
+        return CMD_SUCCESS;
     }
 
     if (NULL == vlan_port_row)
@@ -976,7 +1570,7 @@ DEFUN(cli_intf_vlan_access,
         vlan_port_row = port_check_and_add(ifname, true, true, status_txn);
     }
 
-    if (!check_iface_in_bridge(ifname))
+    if (!vlan_lookup_iface_in_bridge(ifname))
     {
         vty_out(vty, "Failed to set access VLAN. Disable routing on the interface.%s", VTY_NEWLINE);
         cli_do_config_abort(status_txn);
@@ -991,14 +1585,7 @@ DEFUN(cli_intf_vlan_access,
         return CMD_SUCCESS;
     }
 
-    OVSREC_VLAN_FOR_EACH(vlan_row, idl)
-    {
-        if (vlan_row->id == vlan_id)
-        {
-            found_vlan = 1;
-            break;
-        }
-    }
+    found_vlan = (vlan_lookup_vlan(vlan_id) != NULL);
 
     if (0 == found_vlan)
     {
@@ -1032,13 +1619,10 @@ DEFUN(cli_intf_no_vlan_access,
     "Access configuration\n"
     "VLAN identifier\n")
 {
-    const struct ovsrec_port *port_row = NULL;
     const struct ovsrec_port *vlan_port_row = NULL;
-    const struct ovsrec_interface *intf_row = NULL;
     struct ovsdb_idl_txn *status_txn = cli_do_config_start();
     const struct ovsrec_vlan *vlan_row = NULL;
     enum ovsdb_idl_txn_status status;
-    int i = 0;
     int vlan_id = 0;
     bool found_vlan = 0;
 
@@ -1065,14 +1649,7 @@ DEFUN(cli_intf_no_vlan_access,
 
     if(vlan_id != 0)
     {
-        OVSREC_VLAN_FOR_EACH(vlan_row, idl)
-        {
-            if (vlan_row->id == vlan_id)
-            {
-                found_vlan = 1;
-                break;
-            }
-        }
+        found_vlan = (vlan_lookup_vlan(vlan_id) != NULL);
 
         if (!found_vlan)
         {
@@ -1084,41 +1661,12 @@ DEFUN(cli_intf_no_vlan_access,
 
     char *ifname = (char *) vty->index;
 
-    OVSREC_INTERFACE_FOR_EACH(intf_row, idl)
-    {
-        if (strcmp(intf_row->name, ifname) == 0)
-        {
-            break;
-        }
-    }
-
-    port_row = ovsrec_port_first(idl);
-    if (NULL == port_row)
+    vlan_port_row = vlan_lookup_iface_port(ifname);
+    if (vlan_port_row != NULL && strcmp(vlan_port_row->name, ifname) != 0)
     {
-        vlan_port_row = port_check_and_add(ifname, true, true, status_txn);
-    }
-    else
-    {
-        OVSREC_PORT_FOR_EACH(port_row, idl)
-        {
-            for (i = 0; i < port_row->n_interfaces; i++)
-            {
-                if (port_row->interfaces[i] == intf_row)
-                {
-                    if (strcmp(port_row->name, ifname) != 0)
-                    {
-                        vty_out(vty, "Can't configure VLAN, interface is part of LAG %s.%s", port_row->name, VTY_NEWLINE);
-                        cli_do_config_abort(status_txn);
-                        return CMD_SUCCESS;
-                    }
-                    else
-                    {
-                        vlan_port_row = port_row;
-                        break;
-                    }
-                }
-            }
-        }
+        vty_out(vty, "Can't configure VLAN, interface is part of LAG %s.%s", vlan_port_row->name, VTY_NEWLINE);
+        cli_do_config_abort(status_txn);
+        return CMD_SUCCESS;
     }
 
     if (NULL == vlan_port_row)
@@ -1126,7 +1674,7 @@ DEFUN(cli_intf_no_vlan_access,
         vlan_port_row = port_check_and_add(ifname, true, true, status_txn);
     }
 
-    if (!check_iface_in_bridge(ifname))
+    if (!vlan_lookup_iface_in_bridge(ifname))
     {
         vty_out(vty, "Failed to remove access VLAN. Disable routing on the interface.%s", VTY_NEWLINE);
         cli_do_config_abort(status_txn);
@@ -1184,31 +1732,36 @@ DEFUN(cli_intf_vlan_trunk_allowed,
     "Allowed VLANs on the trunk port\n"
     "VLAN identifier range. [2, 2-10 or 2,3,4 or 2,3-10]\n")
 {
-    const struct ovsrec_port *port_row = NULL;
     const struct ovsrec_port *vlan_port_row = NULL;
-    const struct ovsrec_interface *intf_row = NULL;
-    const struct ovsrec_vlan *vlan_row = NULL;
-    struct range_list *temp_to_free, *temp_to_display, *list = NULL;
     struct ovsdb_idl_txn *status_txn = NULL;
     const struct ovsrec_system *const_row = NULL;
     enum ovsdb_idl_txn_status status;
-
+    char *ifname = (char *) vty->index;
+    const struct vlan_lookup *lookup = NULL;
+    unsigned long vids[BITMAP_N_LONGS(VLAN_BITMAP_SIZE)];
+    unsigned long allowed[BITMAP_N_LONGS(VLAN_BITMAP_SIZE)];
     int vlan_id = 0;
     int max_vlan = 0;
     int min_vlan = 0;
 
-    char *in = xmalloc ((strlen(argv[0]) + 1) * sizeof (char));
-    strncpy(in, argv[0], strlen(argv[0]) + 1);
-    list = cmd_get_range_value(in, 0);
-    free(in);
-
-    if (list == NULL)
+    /* The whole range is checked and applied at once, with a single write
+     * of the trunks, instead of one VLAN at a time. */
+    if (!vlan_range_parse(argv[0], vids))
+    {
         return CMD_ERR_NO_MATCH;
+    }
+    vlan_id = bitmap_scan(vids, true, 0, VLAN_BITMAP_SIZE);
 
-    temp_to_display = temp_to_free = list;
     status_txn = cli_do_config_start();
-    const_row = ovsrec_system_first(idl);
+    if (NULL == status_txn)
+    {
+        VLOG_ERR("Failed to create transaction. Function:%s, Line:%d", __func__, __LINE__);
+        cli_do_config_abort(status_txn);
+        vty_out(vty, OVSDB_INTF_VLAN_TRUNK_ALLOWED_ERROR, vlan_id, VTY_NEWLINE);
+        return CMD_SUCCESS;
+    }
 
+    const_row = ovsrec_system_first(idl);
     if (!const_row) {
         VLOG_ERR("[%s:%d]: Failed to retrieve a row from System table\n",
                     __FUNCTION__, __LINE__);
@@ -1222,171 +1775,81 @@ DEFUN(cli_intf_vlan_trunk_allowed,
     max_vlan = smap_get_int(&const_row->other_config,
                     SYSTEM_OTHER_CONFIG_MAP_MAX_INTERNAL_VLAN, -1);
 
-    while (list != NULL)
-    {
-        int i = 0, found_vlan = 0;
-        vlan_id = atoi(list->value);
+    lookup = vlan_lookup_get();
 
-        if (NULL == status_txn)
-        {
-            VLOG_ERR("Failed to create transaction. Function:%s, Line:%d", __func__, __LINE__);
-            cli_do_config_abort(status_txn);
-            vty_out(vty, OVSDB_INTF_VLAN_TRUNK_ALLOWED_ERROR, vlan_id, VTY_NEWLINE);
-            return CMD_SUCCESS;
-        }
-          /* Check for internal vlan use. */
-        if (check_internal_vlan(vlan_id) == 0)
+    BITMAP_FOR_EACH_1(vlan_id, VLAN_BITMAP_SIZE, vids)
+    {
+        /* Check for internal vlan use. */
+        if (bitmap_is_set(lookup->internal, vlan_id))
         {
             vty_out(vty, "Error : Vlan ID-%d is an internal vlan.%s",vlan_id, VTY_NEWLINE);
-            list = list->link;
+            bitmap_set0(vids, vlan_id);
             continue;
         }
 
-
-        char *ifname = (char *) vty->index;
-
         if ((vlan_id >= min_vlan) && (vlan_id <= max_vlan))
         {
-            vty_out(vty, "Unable to set VLAN. VLAN %s is part of internal VLAN.%s",
-                         (list->value), VTY_NEWLINE);
+            vty_out(vty, "Unable to set VLAN. VLAN %d is part of internal VLAN.%s",
+                         vlan_id, VTY_NEWLINE);
             cli_do_config_abort(status_txn);
             return CMD_SUCCESS;
         }
+    }
 
-        OVSREC_INTERFACE_FOR_EACH(intf_row, idl)
-        {
-            if (strcmp(intf_row->name, ifname) == 0)
-            {
-                break;
-            }
-        }
-
-        port_row = ovsrec_port_first(idl);
-        if (NULL == port_row)
-        {
-            vlan_port_row = port_check_and_add(ifname, true, true, status_txn);
-        }
-        else
-        {
-            OVSREC_PORT_FOR_EACH(port_row, idl)
-            {
-                for (i = 0; i < port_row->n_interfaces; i++)
-                {
-                    if (port_row->interfaces[i] == intf_row)
-                    {
-                        if (strcmp(port_row->name, ifname) != 0)
-                        {
-                            vty_out(vty, "Can't configure VLAN, interface is "
-                                         "part of LAG %s.%s", port_row->name,
-                                          VTY_NEWLINE);
-                            cli_do_config_abort(status_txn);
-                            return CMD_SUCCESS;
-                        }
-                        else
-                        {
-                            vlan_port_row = port_row;
-                            break;
-                        }
-                    }
-                }
-            }
-        }
-
-        if (NULL == vlan_port_row )
-        {
-            vlan_port_row = port_check_and_add(ifname, true, true, status_txn);
-        }
+    if (bitmap_is_all_zeros(vids, VLAN_BITMAP_SIZE))
+    {
+        /* Nothing left to allow. */
+        cli_do_config_abort(status_txn);
+        return CMD_SUCCESS;
+    }
 
-        if (!check_iface_in_bridge(ifname))
-        {
-            vty_out(vty, "Failed to set allowed trunk VLAN. Disable routing on"
-                         " the interface %s.%s", ifname, VTY_NEWLINE);
-            cli_do_config_abort(status_txn);
-            return CMD_SUCCESS;
-        }
+    vlan_port_row = vlan_lookup_iface_port(ifname);
+    if (vlan_port_row != NULL && strcmp(vlan_port_row->name, ifname) != 0)
+    {
+        vty_out(vty, "Can't configure VLAN, interface is part of LAG %s.%s", vlan_port_row->name, VTY_NEWLINE);
+        cli_do_config_abort(status_txn);
+        return CMD_SUCCESS;
+    }
 
-        vlan_row = ovsrec_vlan_first(idl);
-        if (NULL == vlan_row)
-        {
-            vty_out(vty, "VLAN %d not found for interface %s, aborting all the"
-                         " VLAN's ", vlan_id, ifname);
-            while (temp_to_display->link != NULL)
-            {
-                vty_out (vty, "%s, ", (temp_to_display->value));
-                temp_to_display = temp_to_display->link;
-            }
-            vty_out (vty, "%s configurations.%s", (temp_to_display->value), VTY_NEWLINE);
-            temp_to_display = NULL;
-            cli_do_config_abort(status_txn);
-            return CMD_SUCCESS;
-        }
+    if (NULL == vlan_port_row)
+    {
+        vlan_port_row = port_check_and_add(ifname, true, true, status_txn);
+    }
 
-        OVSREC_VLAN_FOR_EACH(vlan_row, idl)
-        {
-            if (vlan_row->id == vlan_id)
-            {
-                found_vlan = 1;
-                break;
-            }
-        }
+    if (!vlan_lookup_iface_in_bridge(ifname))
+    {
+        vty_out(vty, "Failed to set allowed trunk VLAN. Disable routing on"
+                     " the interface %s.%s", ifname, VTY_NEWLINE);
+        cli_do_config_abort(status_txn);
+        return CMD_SUCCESS;
+    }
 
-        if (0 == found_vlan)
+    BITMAP_FOR_EACH_1(vlan_id, VLAN_BITMAP_SIZE, vids)
+    {
+        if (!bitmap_is_set(lookup->vlan_ids, vlan_id))
         {
             vty_out(vty, "VLAN %d not found for interface %s, aborting all the"
-                         " VLAN's ", vlan_id, ifname);
-            while (temp_to_display->link != NULL)
-            {
-                vty_out (vty, "%s, ", (temp_to_display->value));
-                temp_to_display = temp_to_display->link;
-            }
-            vty_out (vty, "%s configurations.%s", (temp_to_display->value), VTY_NEWLINE);
-            temp_to_display = NULL;
+                         " VLAN's %s configurations.%s", vlan_id, ifname,
+                         argv[0], VTY_NEWLINE);
             cli_do_config_abort(status_txn);
             return CMD_SUCCESS;
         }
+    }
 
-        if (strcmp(vlan_port_row->vlan_mode, OVSREC_PORT_VLAN_MODE_NATIVE_TAGGED) != 0 &&
-                 strcmp(vlan_port_row->vlan_mode, OVSREC_PORT_VLAN_MODE_NATIVE_UNTAGGED) != 0)
-        {
-            ovsrec_port_set_vlan_mode(vlan_port_row, OVSREC_PORT_VLAN_MODE_NATIVE_UNTAGGED);
-        }
-
-        int64_t* trunks = NULL;
-        for (i = 0; i < vlan_port_row->n_vlan_trunks; i++)
-        {
-            if (vlan_id == ops_port_get_trunks(vlan_port_row, i))
-            {
-                vty_out(vty, "The VLAN %d is already allowed on the interface"
-                             "%s.%s", vlan_id, ifname, VTY_NEWLINE);
-                status = cli_do_config_finish(status_txn);
-                if (status == TXN_SUCCESS || status == TXN_UNCHANGED)
-                {
-                    return CMD_SUCCESS;
-                }
-                else
-                {
-                    VLOG_DBG("Transaction failed to set allowed trunk VLAN %d. Function:%s, Line:%d", vlan_id, __func__, __LINE__);
-                    vty_out(vty, OVSDB_INTF_VLAN_TRUNK_ALLOWED_ERROR, vlan_id, VTY_NEWLINE);
-                    return CMD_SUCCESS;
-                }
-            }
-        }
-
-        trunks = xmalloc(sizeof(int64_t) * (vlan_port_row->n_vlan_trunks + 1));
-        for (i = 0; i < vlan_port_row->n_vlan_trunks; i++)
-        {
-            trunks[i] = ops_port_get_trunks(vlan_port_row, i);
-        }
-        trunks[vlan_port_row->n_vlan_trunks] = vlan_id;
-        int trunk_count = vlan_port_row->n_vlan_trunks + 1;
-        ops_port_set_trunks(trunks, trunk_count, vlan_port_row, idl);
+    if (strcmp(vlan_port_row->vlan_mode, OVSREC_PORT_VLAN_MODE_NATIVE_TAGGED) != 0 &&
+             strcmp(vlan_port_row->vlan_mode, OVSREC_PORT_VLAN_MODE_NATIVE_UNTAGGED) != 0)
+    {
+        ovsrec_port_set_vlan_mode(vlan_port_row, OVSREC_PORT_VLAN_MODE_NATIVE_UNTAGGED);
+    }
 
-        list = list->link;
-        free(trunks);
+    vlan_port_add_trunks(vlan_port_row, vids, allowed);
+    BITMAP_FOR_EACH_1(vlan_id, VLAN_BITMAP_SIZE, allowed)
+    {
+        vty_out(vty, "The VLAN %d is already allowed on the interface"
+                     "%s.%s", vlan_id, ifname, VTY_NEWLINE);
     }
-    status = cli_do_config_finish(status_txn);
 
-    temp_to_free = cmd_free_memory_range_list(temp_to_free);
+    status = cli_do_config_finish(status_txn);
 
     if (status == TXN_SUCCESS || status == TXN_UNCHANGED)
     {
@@ -1394,6 +1857,7 @@ DEFUN(cli_intf_vlan_trunk_allowed,
     }
     else
     {
+        vlan_id = bitmap_scan(vids, true, 0, VLAN_BITMAP_SIZE);
         VLOG_DBG("Transaction failed to set allowed trunk VLAN %d. Function:%s, Line:%d", vlan_id, __func__, __LINE__);
         vty_out(vty, OVSDB_INTF_VLAN_TRUNK_ALLOWED_ERROR, vlan_id, VTY_NEWLINE);
         return CMD_SUCCESS;
@@ -1402,78 +1866,45 @@ DEFUN(cli_intf_vlan_trunk_allowed,
 
 DEFUN(cli_intf_no_vlan_trunk_allowed,
     cli_intf_no_vlan_trunk_allowed_cmd,
-    "no vlan trunk allowed <1-4094>",
+    "no vlan trunk allowed <A:1-4094>",
     NO_STR
     VLAN_STR
     TRUNK_STR
     "Allowed vlans on the trunk port\n"
-    "VLAN identifier\n")
+    "VLAN identifier range. [2, 2-10 or 2,3,4 or 2,3-10]\n")
 {
-    const struct ovsrec_port *port_row = NULL;
     const struct ovsrec_port *vlan_port_row = NULL;
-    const struct ovsrec_interface *intf_row = NULL;
-    struct ovsdb_idl_txn *status_txn = cli_do_config_start();
+    struct ovsdb_idl_txn *status_txn = NULL;
     enum ovsdb_idl_txn_status status;
-    int vlan_id = atoi((char *) argv[0]);
-    int i = 0, n = 0;
-    bool is_vlan_found = false;
+    unsigned long vids[BITMAP_N_LONGS(VLAN_BITMAP_SIZE)];
+    int vlan_id = 0;
     char *ifname = (char *) vty->index;
-    int64_t* trunks = NULL;
-    int trunk_count = 0;
-
-    if (NULL == status_txn)
-    {
-        VLOG_ERR("Failed to create transaction. Function:%s, Line:%d", __func__, __LINE__);
-        cli_do_config_abort(status_txn);
-        vty_out(vty, "Failed to remove trunk VLAN%s", VTY_NEWLINE);
-        return CMD_SUCCESS;
-    }
-
+    size_t trunk_count = 0;
 
-    OVSREC_INTERFACE_FOR_EACH(intf_row, idl)
+    if (!vlan_range_parse(argv[0], vids))
     {
-        if (strcmp(intf_row->name, ifname) == 0)
-        {
-            break;
-        }
+        return CMD_ERR_NO_MATCH;
     }
+    vlan_id = bitmap_scan(vids, true, 0, VLAN_BITMAP_SIZE);
 
-    port_row = ovsrec_port_first(idl);
-    if (NULL == port_row)
+    status_txn = cli_do_config_start();
+    if (NULL == status_txn)
     {
+        VLOG_ERR("Failed to create transaction. Function:%s, Line:%d", __func__, __LINE__);
         cli_do_config_abort(status_txn);
+        vty_out(vty, "Failed to remove trunk VLAN%s", VTY_NEWLINE);
         return CMD_SUCCESS;
     }
-    else
-    {
-        OVSREC_PORT_FOR_EACH(port_row, idl)
-        {
-            for (i = 0; i < port_row->n_interfaces; i++)
-            {
-                if (port_row->interfaces[i] == intf_row)
-                {
-                    if (strcmp(port_row->name, ifname) != 0)
-                    {
-                        cli_do_config_abort(status_txn);
-                        return CMD_SUCCESS;
-                    }
-                    else
-                    {
-                        vlan_port_row = port_row;
-                        break;
-                    }
-                }
-            }
-        }
-    }
 
-    if (NULL == vlan_port_row)
+
+    vlan_port_row = vlan_lookup_iface_port(ifname);
+    if (NULL == vlan_port_row || strcmp(vlan_port_row->name, ifname) != 0)
     {
         cli_do_config_abort(status_txn);
         return CMD_SUCCESS;
     }
 
-    if (!check_iface_in_bridge(ifname))
+    if (!vlan_lookup_port_in_bridge(ifname))
     {
         vty_out(vty, "Failed to remove trunk VLAN. Disable routing on the interface.%s", VTY_NEWLINE);
         cli_do_config_abort(status_txn);
@@ -1490,29 +1921,7 @@ DEFUN(cli_intf_no_vlan_trunk_allowed,
         return CMD_SUCCESS;
     }
 
-    trunk_count = vlan_port_row->n_vlan_trunks;
-    for (i = 0; i < vlan_port_row->n_vlan_trunks; i++)
-    {
-        if (vlan_id == ops_port_get_trunks(vlan_port_row, i))
-        {
-            is_vlan_found = true;
-            trunks = xmalloc(sizeof(int64_t) * (vlan_port_row->n_vlan_trunks - 1));
-
-            for (i = n = 0; i < vlan_port_row->n_vlan_trunks; i++)
-            {
-                if (vlan_id != ops_port_get_trunks(vlan_port_row, i))
-                {
-                    trunks[n++] = ops_port_get_trunks(vlan_port_row, i);
-                }
-            }
-            trunk_count = vlan_port_row->n_vlan_trunks - 1;
-            ops_port_set_trunks(trunks, trunk_count, vlan_port_row, idl);
-            free(trunks);
-            break;
-        }
-    }
-
-    if (is_vlan_found == false)
+    if (!vlan_port_prune_trunks(vlan_port_row, vids, &trunk_count))
     {
         cli_do_config_abort(status_txn);
         return CMD_SUCCESS;
@@ -1550,15 +1959,12 @@ DEFUN(cli_intf_vlan_trunk_native,
     "Native VLAN on the trunk port\n"
     "VLAN identifier\n")
 {
-    const struct ovsrec_port *port_row = NULL;
     const struct ovsrec_port *vlan_port_row = NULL;
-    const struct ovsrec_interface *intf_row = NULL;
-     const struct ovsrec_interface * tmp_row = NULL;
     const struct ovsrec_vlan *vlan_row = NULL;
     struct ovsdb_idl_txn *status_txn = cli_do_config_start();
     enum ovsdb_idl_txn_status status;
     int vlan_id = atoi((char *) argv[0]);
-    int i = 0, found_vlan = 0;
+    int found_vlan = 0;
 
     if (NULL == status_txn)
     {
@@ -1569,52 +1975,21 @@ DEFUN(cli_intf_vlan_trunk_native,
     }
 
      /* Check for internal vlan use. */
-    OVSREC_INTERFACE_FOR_EACH(tmp_row, idl) {
-        if (check_internal_vlan(vlan_id) == 0)
-        {
-            vty_out(vty, "Error : Vlan ID-%d is an internal vlan.%s",vlan_id, VTY_NEWLINE);
-            cli_do_config_abort(status_txn);
-            return CMD_SUCCESS;
-        }
+    if (vlan_lookup_is_internal(vlan_id))
+    {
+        vty_out(vty, "Error : Vlan ID-%d is an internal vlan.%s",vlan_id, VTY_NEWLINE);
+        cli_do_config_abort(status_txn);
+        return CMD_SUCCESS;
     }
 
     char *ifname = (char *) vty->index;
 
-    OVSREC_INTERFACE_FOR_EACH(intf_row, idl)
-    {
-        if (strcmp(intf_row->name, ifname) == 0)
-        {
-            break;
-        }
-    }
-
-    port_row = ovsrec_port_first(idl);
-    if (port_row == NULL)
-    {
-        vlan_port_row = port_check_and_add(ifname, true, true, status_txn);
-    }
-    else
+    vlan_port_row = vlan_lookup_iface_port(ifname);
+    if (vlan_port_row != NULL && strcmp(vlan_port_row->name, ifname) != 0)
     {
-        OVSREC_PORT_FOR_EACH(port_row, idl)
-        {
-            for (i = 0; i < port_row->n_interfaces; i++)
-            {
-                if (port_row->interfaces[i] == intf_row)
-                {
-                    if (strcmp(port_row->name, ifname) != 0)
-                    {
-                        vty_out(vty, "Can't configure VLAN, interface is part of LAG %s.%s", port_row->name, VTY_NEWLINE);
-                        cli_do_config_abort(status_txn);
-                        return CMD_SUCCESS;
-                    }
-                    else
-                    {
-                        vlan_port_row = port_row;
-                        break;
-                    }
-                }
-            }
-        }
+        vty_out(vty, "Can't configure VLAN, interface is part of LAG %s.%s", vlan_port_row->name, VTY_NEWLINE);
+        cli_do_config_abort(status_txn);
+        return CMD_SUCCESS;
     }
 
     if (NULL == vlan_port_row)
@@ -1622,7 +1997,7 @@ DEFUN(cli_intf_vlan_trunk_native,
         vlan_port_row = port_check_and_add(ifname, true, true, status_txn);
     }
 
-    if (!check_iface_in_bridge(ifname))
+    if (!vlan_lookup_iface_in_bridge(ifname))
     {
         vty_out(vty, "Failed to add native vlan. Disable routing on the interface.%s", VTY_NEWLINE);
         cli_do_config_abort(status_txn);
@@ -1637,14 +2012,7 @@ DEFUN(cli_intf_vlan_trunk_native,
         return CMD_SUCCESS;
     }
 
-    OVSREC_VLAN_FOR_EACH(vlan_row, idl)
-    {
-        if (vlan_row->id == vlan_id)
-        {
-            found_vlan = 1;
-            break;
-        }
-    }
+    found_vlan = (vlan_lookup_vlan(vlan_id) != NULL);
 
     if (found_vlan == 0)
     {
@@ -1688,12 +2056,9 @@ DEFUN(cli_intf_no_vlan_trunk_native,
     "Native VLAN on the trunk port\n"
     "VLAN identifier\n")
 {
-    const struct ovsrec_port *port_row = NULL;
     const struct ovsrec_port* vlan_port_row = NULL;
-    const struct ovsrec_interface *intf_row = NULL;
     struct ovsdb_idl_txn *status_txn = cli_do_config_start();
     enum ovsdb_idl_txn_status status;
-    int i = 0;
     int vlan_id = 0;
     if(argc > 0 && argv[0] != NULL)
     {
@@ -1710,41 +2075,12 @@ DEFUN(cli_intf_no_vlan_trunk_native,
 
     char *ifname = (char *) vty->index;
 
-    OVSREC_INTERFACE_FOR_EACH(intf_row, idl)
-    {
-        if (strcmp(intf_row->name, ifname) == 0)
-        {
-            break;
-        }
-    }
-
-    port_row = ovsrec_port_first(idl);
-    if (port_row == NULL)
+    vlan_port_row = vlan_lookup_iface_port(ifname);
+    if (vlan_port_row != NULL && strcmp(vlan_port_row->name, ifname) != 0)
     {
-        vlan_port_row = port_check_and_add(ifname, true, true, status_txn);
-    }
-    else
-    {
-        OVSREC_PORT_FOR_EACH(port_row, idl)
-        {
-            for (i = 0; i < port_row->n_interfaces; i++)
-            {
-                if (port_row->interfaces[i] == intf_row)
-                {
-                    if (strcmp(port_row->name, ifname) != 0)
-                    {
-                        vty_out(vty, "Can't configure VLAN, interface is part of LAG %s.%s", port_row->name, VTY_NEWLINE);
-                        cli_do_config_abort(status_txn);
-                        return CMD_SUCCESS;
-                    }
-                    else
-                    {
-                        vlan_port_row = port_row;
-                        break;
-                    }
-                }
-            }
-        }
+        vty_out(vty, "Can't configure VLAN, interface is part of LAG %s.%s", vlan_port_row->name, VTY_NEWLINE);
+        cli_do_config_abort(status_txn);
+        return CMD_SUCCESS;
     }
 
     if (NULL == vlan_port_row)
@@ -1752,7 +2088,7 @@ DEFUN(cli_intf_no_vlan_trunk_native,
         vlan_port_row = port_check_and_add(ifname, true, true, status_txn);
     }
 
-    if (!check_iface_in_bridge(ifname))
+    if (!vlan_lookup_iface_in_bridge(ifname))
     {
         vty_out(vty, "Failed to remove native VLAN. Disable routing on the interface.%s", VTY_NEWLINE);
         cli_do_config_abort(status_txn);
@@ -1811,12 +2147,9 @@ DEFUN(cli_intf_vlan_trunk_native_tag,
     "Native VLAN on the trunk port\n"
     "Tag configuration on the trunk port\n")
 {
-    const struct ovsrec_port *port_row = NULL;
     const struct ovsrec_port *vlan_port_row = NULL;
-    const struct ovsrec_interface *intf_row = NULL;
     struct ovsdb_idl_txn *status_txn = cli_do_config_start();
     enum ovsdb_idl_txn_status status;
-    int i = 0;
 
     if (NULL == status_txn)
     {
@@ -1828,49 +2161,20 @@ DEFUN(cli_intf_vlan_trunk_native_tag,
 
     char *ifname = (char *) vty->index;
 
-    OVSREC_INTERFACE_FOR_EACH(intf_row, idl)
-    {
-        if (strcmp(intf_row->name, ifname) == 0)
-        {
-            break;
-        }
-    }
-
-    port_row = ovsrec_port_first(idl);
-    if (port_row == NULL)
-    {
-        vlan_port_row = port_check_and_add(ifname, true, true, status_txn);
-    }
-    else
+    vlan_port_row = vlan_lookup_iface_port(ifname);
+    if (vlan_port_row != NULL && strcmp(vlan_port_row->name, ifname) != 0)
     {
-        OVSREC_PORT_FOR_EACH(port_row, idl)
-        {
-            for (i = 0; i < port_row->n_interfaces; i++)
-            {
-                if (port_row->interfaces[i] == intf_row)
-                {
-                    if (strcmp(port_row->name, ifname) != 0)
-                    {
-                        vty_out(vty, "Can't configure VLAN, interface is part of LAG %s.%s", port_row->name, VTY_NEWLINE);
-                        cli_do_config_abort(status_txn);
-                        return CMD_SUCCESS;
-                    }
-                    else
-                    {
-                        vlan_port_row = port_row;
-                        break;
-                    }
-                }
-            }
-        }
+        vty_out(vty, "Can't configure VLAN, interface is part of LAG %s.%s", vlan_port_row->name, VTY_NEWLINE);
+        cli_do_config_abort(status_txn);
+        return CMD_SUCCESS;
     }
 
-    if (vlan_port_row == NULL)
+    if (NULL == vlan_port_row)
     {
         vlan_port_row = port_check_and_add(ifname, true, true, status_txn);
     }
 
-    if (!check_iface_in_bridge(ifname))
+    if (!vlan_lookup_iface_in_bridge(ifname))
     {
         vty_out(vty, "Failed to set native VLAN tagging. Disable routing on the interface.%s", VTY_NEWLINE);
         cli_do_config_abort(status_txn);
@@ -1910,12 +2214,9 @@ DEFUN(cli_intf_no_vlan_trunk_native_tag,
     "Native VLAN on the trunk port\n"
     "VLAN identifier\n")
 {
-    const struct ovsrec_port *port_row = NULL;
     const struct ovsrec_port *vlan_port_row = NULL;
-    const struct ovsrec_interface *intf_row = NULL;
     struct ovsdb_idl_txn *status_txn = cli_do_config_start();
     enum ovsdb_idl_txn_status status;
-    int i = 0;
 
     if (NULL == status_txn)
     {
@@ -1927,49 +2228,20 @@ DEFUN(cli_intf_no_vlan_trunk_native_tag,
 
     char *ifname = (char *) vty->index;
 
-    OVSREC_INTERFACE_FOR_EACH(intf_row, idl)
+    vlan_port_row = vlan_lookup_iface_port(ifname);
+    if (vlan_port_row != NULL && strcmp(vlan_port_row->name, ifname) != 0)
     {
-        if (strcmp(intf_row->name, ifname) == 0)
-        {
-            break;
-        }
-    }
-
-    port_row = ovsrec_port_first(idl);
-    if (port_row == NULL)
-    {
-        vlan_port_row = port_check_and_add(ifname, true, true, status_txn);
-    }
-    else
-    {
-        OVSREC_PORT_FOR_EACH(port_row, idl)
-        {
-            for (i = 0; i < port_row->n_interfaces; i++)
-            {
-                if (port_row->interfaces[i] == intf_row)
-                {
-                    if (strcmp(port_row->name, ifname) != 0)
-                    {
-                        vty_out(vty, "Can't configure VLAN, interface is part of LAG %s.%s", port_row->name, VTY_NEWLINE);
-                        cli_do_config_abort(status_txn);
-                        return CMD_SUCCESS;
-                    }
-                    else
-                    {
-                        vlan_port_row = port_row;
-                        break;
-                    }
-                }
-            }
-        }
+        vty_out(vty, "Can't configure VLAN, interface is part of LAG %s.%s", vlan_port_row->name, VTY_NEWLINE);
+        cli_do_config_abort(status_txn);
+        return CMD_SUCCESS;
     }
 
-    if (vlan_port_row == NULL)
+    if (NULL == vlan_port_row)
     {
         vlan_port_row = port_check_and_add(ifname, true, true, status_txn);
     }
 
-    if (!check_iface_in_bridge(ifname))
+    if (!vlan_lookup_iface_in_bridge(ifname))
     {
         vty_out(vty, "Failed to remove native VLAN tagging. Disable routing on the interface.%s", VTY_NEWLINE);
         cli_do_config_abort(status_txn);
@@ -2006,7 +2278,6 @@ DEFUN(cli_lag_vlan_access,
     "Access Configuration\n"
     "VLAN identifier\n")
 {
-    const struct ovsrec_port *port_row = NULL;
     const struct ovsrec_port *vlan_port_row = NULL;
     const struct ovsrec_vlan *vlan_row = NULL;
     struct ovsdb_idl_txn *status_txn = cli_do_config_start();
@@ -2023,7 +2294,7 @@ DEFUN(cli_lag_vlan_access,
     }
 
     char *lagname = (char *) vty->index;
-    if (!check_port_in_bridge(lagname))
+    if (!vlan_lookup_port_in_bridge(lagname))
     {
         vty_out(vty, "Failed to set access VLAN. Disable routing on the LAG.%s", VTY_NEWLINE);
         cli_do_config_abort(status_txn);
@@ -2038,14 +2309,7 @@ DEFUN(cli_lag_vlan_access,
         return CMD_SUCCESS;
     }
 
-    OVSREC_VLAN_FOR_EACH(vlan_row, idl)
-    {
-        if (vlan_row->id == vlan_id)
-        {
-            found_vlan = 1;
-            break;
-        }
-    }
+    found_vlan = (vlan_lookup_vlan(vlan_id) != NULL);
 
     if (found_vlan == 0)
     {
@@ -2054,14 +2318,7 @@ DEFUN(cli_lag_vlan_access,
         return CMD_SUCCESS;
     }
 
-    OVSREC_PORT_FOR_EACH(port_row, idl)
-    {
-        if (strcmp(port_row->name, lagname) == 0)
-        {
-            vlan_port_row = port_row;
-            break;
-        }
-    }
+    vlan_port_row = vlan_lookup_port(lagname);
 
     ovsrec_port_set_vlan_mode(vlan_port_row, OVSREC_PORT_VLAN_MODE_ACCESS);
     ops_port_set_tag(vlan_id, vlan_port_row, idl);
@@ -2089,7 +2346,6 @@ DEFUN(cli_lag_no_vlan_access,
     "Access configuration\n"
     "VLAN identifier\n")
 {
-    const struct ovsrec_port *port_row = NULL;
     const struct ovsrec_port *vlan_port_row = NULL;
     struct ovsdb_idl_txn *status_txn = cli_do_config_start();
     enum ovsdb_idl_txn_status status;
@@ -2103,21 +2359,14 @@ DEFUN(cli_lag_no_vlan_access,
     }
 
     char *lagname = (char *) vty->index;
-    if (!check_port_in_bridge(lagname))
+    if (!vlan_lookup_port_in_bridge(lagname))
     {
         vty_out(vty, "Failed to remove access VLAN. Disable routing on the LAG.%s", VTY_NEWLINE);
         cli_do_config_abort(status_txn);
         return CMD_SUCCESS;
     }
 
-    OVSREC_PORT_FOR_EACH(port_row, idl)
-    {
-        if (strcmp(port_row->name, lagname) == 0)
-        {
-            vlan_port_row = port_row;
-            break;
-        }
-    }
+    vlan_port_row = vlan_lookup_port(lagname);
 
     if(vlan_port_row == NULL)
     {
@@ -2153,20 +2402,29 @@ DEFUN(cli_lag_no_vlan_access,
 
 DEFUN(cli_lag_vlan_trunk_allowed,
     cli_lag_vlan_trunk_allowed_cmd,
-    "vlan trunk allowed <1-4094>",
+    "vlan trunk allowed <A:1-4094>",
     VLAN_STR
     TRUNK_STR
     "Allowed vlans on the trunk port\n"
-    "VLAN identifier\n")
+    "VLAN identifier range. [2, 2-10 or 2,3,4 or 2,3-10]\n")
 {
-    const struct ovsrec_port *port_row = NULL;
     const struct ovsrec_port *vlan_port_row = NULL;
-    const struct ovsrec_vlan *vlan_row = NULL;
-    struct ovsdb_idl_txn *status_txn = cli_do_config_start();
+    struct ovsdb_idl_txn *status_txn = NULL;
     enum ovsdb_idl_txn_status status;
-    int vlan_id = atoi((char *) argv[0]);
-    int i = 0, found_vlan = 0;
+    const struct vlan_lookup *lookup = NULL;
+    unsigned long vids[BITMAP_N_LONGS(VLAN_BITMAP_SIZE)];
+    unsigned long allowed[BITMAP_N_LONGS(VLAN_BITMAP_SIZE)];
+    int vlan_id = 0;
+
+    /* The whole range is checked and applied at once, with a single write
+     * of the trunks, instead of one VLAN at a time. */
+    if (!vlan_range_parse(argv[0], vids))
+    {
+        return CMD_ERR_NO_MATCH;
+    }
+    vlan_id = bitmap_scan(vids, true, 0, VLAN_BITMAP_SIZE);
 
+    status_txn = cli_do_config_start();
     if (NULL == status_txn)
     {
         VLOG_ERR("Failed to create transaction. Function:%s, Line:%d", __func__, __LINE__);
@@ -2176,45 +2434,40 @@ DEFUN(cli_lag_vlan_trunk_allowed,
     }
 
     char *lagname = (char *) vty->index;
-    if (!check_port_in_bridge(lagname))
+    if (!vlan_lookup_port_in_bridge(lagname))
     {
         vty_out(vty, "Failed to remove access VLAN. Disable routing on the LAG.%s", VTY_NEWLINE);
         cli_do_config_abort(status_txn);
         return CMD_SUCCESS;
     }
 
-    vlan_row = ovsrec_vlan_first(idl);
-    if (vlan_row == NULL)
+    lookup = vlan_lookup_get();
+    BITMAP_FOR_EACH_1(vlan_id, VLAN_BITMAP_SIZE, vids)
     {
-        vty_out(vty, "VLAN %d not found%s", vlan_id, VTY_NEWLINE);
-        cli_do_config_abort(status_txn);
-        return CMD_SUCCESS;
-    }
+        /* Check for internal vlan use. */
+        if (bitmap_is_set(lookup->internal, vlan_id))
+        {
+            vty_out(vty, "Error : Vlan ID-%d is an internal vlan.%s",vlan_id, VTY_NEWLINE);
+            bitmap_set0(vids, vlan_id);
+            continue;
+        }
 
-    OVSREC_VLAN_FOR_EACH(vlan_row, idl)
-    {
-        if (vlan_row->id == vlan_id)
+        if (!bitmap_is_set(lookup->vlan_ids, vlan_id))
         {
-            found_vlan = 1;
-            break;
+            vty_out(vty, "VLAN %d not found%s", vlan_id, VTY_NEWLINE);
+            cli_do_config_abort(status_txn);
+            return CMD_SUCCESS;
         }
     }
 
-    if (found_vlan == 0)
+    if (bitmap_is_all_zeros(vids, VLAN_BITMAP_SIZE))
     {
-        vty_out(vty, "VLAN %d not found%s", vlan_id, VTY_NEWLINE);
+        /* Nothing left to allow. */
         cli_do_config_abort(status_txn);
         return CMD_SUCCESS;
     }
 
-    OVSREC_PORT_FOR_EACH(port_row, idl)
-    {
-        if (strcmp(port_row->name, lagname) == 0)
-        {
-            vlan_port_row = port_row;
-            break;
-        }
-    }
+    vlan_port_row = vlan_lookup_port(lagname);
 
     if (vlan_port_row->vlan_mode == NULL)
     {
@@ -2226,37 +2479,13 @@ DEFUN(cli_lag_vlan_trunk_allowed,
         ovsrec_port_set_vlan_mode(vlan_port_row, OVSREC_PORT_VLAN_MODE_TRUNK);
     }
 
-    int64_t* trunks = NULL;
-    for (i = 0; i < vlan_port_row->n_vlan_trunks; i++)
-    {
-        if (vlan_id == ops_port_get_trunks(vlan_port_row, i))
-        {
-            vty_out(vty, "The VLAN is already allowed on the LAG.%s", VTY_NEWLINE);
-            status = cli_do_config_finish(status_txn);
-            if (status == TXN_SUCCESS || status == TXN_UNCHANGED)
-            {
-                return CMD_SUCCESS;
-            }
-            else
-            {
-                VLOG_DBG("Transaction failed to set allowed trunk VLAN %d. Function:%s, Line:%d", vlan_id, __func__, __LINE__);
-                vty_out(vty, OVSDB_INTF_VLAN_TRUNK_ALLOWED_ERROR, vlan_id, VTY_NEWLINE);
-                return CMD_SUCCESS;
-            }
-        }
-    }
-
-    trunks = xmalloc(sizeof(int64_t) * (vlan_port_row->n_vlan_trunks + 1));
-    for (i = 0; i < vlan_port_row->n_vlan_trunks; i++)
+    vlan_port_add_trunks(vlan_port_row, vids, allowed);
+    BITMAP_FOR_EACH_1(vlan_id, VLAN_BITMAP_SIZE, allowed)
     {
-        trunks[i] = ops_port_get_trunks(vlan_port_row, i);
+        vty_out(vty, "The VLAN %d is already allowed on the LAG.%s", vlan_id, VTY_NEWLINE);
     }
-    trunks[vlan_port_row->n_vlan_trunks] = vlan_id;
-    int trunk_count = vlan_port_row->n_vlan_trunks + 1;
-    ops_port_set_trunks(trunks, trunk_count, vlan_port_row, idl);
 
     status = cli_do_config_finish(status_txn);
-    free(trunks);
 
     if (status == TXN_SUCCESS || status == TXN_UNCHANGED)
     {
@@ -2264,6 +2493,7 @@ DEFUN(cli_lag_vlan_trunk_allowed,
     }
     else
     {
+        vlan_id = bitmap_scan(vids, true, 0, VLAN_BITMAP_SIZE);
         VLOG_DBG("Transaction failed to set allowed trunk VLAN %d. Function:%s, Line:%d", vlan_id, __func__, __LINE__);
         vty_out(vty, OVSDB_INTF_VLAN_TRUNK_ALLOWED_ERROR, vlan_id, VTY_NEWLINE);
         return CMD_SUCCESS;
@@ -2272,20 +2502,27 @@ DEFUN(cli_lag_vlan_trunk_allowed,
 
 DEFUN(cli_lag_no_vlan_trunk_allowed,
     cli_lag_no_vlan_trunk_allowed_cmd,
-    "no vlan trunk allowed <1-4094>",
+    "no vlan trunk allowed <A:1-4094>",
     NO_STR
     VLAN_STR
     TRUNK_STR
     "Allowed vlans on the trunk port\n"
-    "VLAN identifier\n")
+    "VLAN identifier range. [2, 2-10 or 2,3,4 or 2,3-10]\n")
 {
-    const struct ovsrec_port *port_row = NULL;
     const struct ovsrec_port *vlan_port_row = NULL;
-    struct ovsdb_idl_txn *status_txn = cli_do_config_start();
+    struct ovsdb_idl_txn *status_txn = NULL;
     enum ovsdb_idl_txn_status status;
-    int vlan_id = atoi((char *) argv[0]);
-    int i = 0, n = 0;
+    unsigned long vids[BITMAP_N_LONGS(VLAN_BITMAP_SIZE)];
+    int vlan_id = 0;
+    size_t trunk_count = 0;
+
+    if (!vlan_range_parse(argv[0], vids))
+    {
+        return CMD_ERR_NO_MATCH;
+    }
+    vlan_id = bitmap_scan(vids, true, 0, VLAN_BITMAP_SIZE);
 
+    status_txn = cli_do_config_start();
     if (NULL == status_txn)
     {
         VLOG_ERR("Failed to create transaction. Function:%s, Line:%d", __func__, __LINE__);
@@ -2295,21 +2532,14 @@ DEFUN(cli_lag_no_vlan_trunk_allowed,
     }
 
     char *lagname = (char *) vty->index;
-    if (!check_port_in_bridge(lagname))
+    if (!vlan_lookup_port_in_bridge(lagname))
     {
         vty_out(vty, "Failed to remove trunk VLAN. Disable routing on the LAG.%s", VTY_NEWLINE);
         cli_do_config_abort(status_txn);
         return CMD_SUCCESS;
     }
 
-    OVSREC_PORT_FOR_EACH(port_row, idl)
-    {
-        if (strcmp(port_row->name, lagname) == 0)
-        {
-            vlan_port_row = port_row;
-            break;
-        }
-    }
+    vlan_port_row = vlan_lookup_port(lagname);
 
     if(vlan_port_row == NULL)
     {
@@ -2328,28 +2558,10 @@ DEFUN(cli_lag_no_vlan_trunk_allowed,
         return CMD_SUCCESS;
     }
 
-    int64_t* trunks = NULL;
-    int trunk_count = vlan_port_row->n_vlan_trunks;
-    for (i = 0; i < vlan_port_row->n_vlan_trunks; i++)
-    {
-        if (vlan_id == ops_port_get_trunks(vlan_port_row, i))
-        {
-            trunks = xmalloc(sizeof (int64_t) * (vlan_port_row->n_vlan_trunks - 1));
-            for (i = n = 0; i < vlan_port_row->n_vlan_trunks; i++)
-            {
-                if (vlan_id != ops_port_get_trunks(vlan_port_row, i))
-                {
-                    trunks[n++] = ops_port_get_trunks(vlan_port_row, i);
-                }
-            }
-            trunk_count = vlan_port_row->n_vlan_trunks - 1;
-            ops_port_set_trunks(trunks, trunk_count, vlan_port_row, idl);
-            free(trunks);
-            break;
-        }
-    }
+    vlan_port_prune_trunks(vlan_port_row, vids, &trunk_count);
 
-    if (strcmp(vlan_port_row->vlan_mode, OVSREC_PORT_VLAN_MODE_TRUNK) == 0)
+    if (vlan_port_row->vlan_mode != NULL &&
+        strcmp(vlan_port_row->vlan_mode, OVSREC_PORT_VLAN_MODE_TRUNK) == 0)
     {
         if (trunk_count == 0)
         {
@@ -2380,7 +2592,6 @@ DEFUN(cli_lag_vlan_trunk_native,
     "Native VLAN on the trunk port\n"
     "VLAN identifier\n")
 {
-    const struct ovsrec_port *port_row = NULL;
     const struct ovsrec_port *vlan_port_row = NULL;
     const struct ovsrec_vlan *vlan_row = NULL;
     struct ovsdb_idl_txn *status_txn = cli_do_config_start();
@@ -2397,7 +2608,7 @@ DEFUN(cli_lag_vlan_trunk_native,
     }
 
     char *lagname = (char *) vty->index;
-    if (!check_port_in_bridge(lagname))
+    if (!vlan_lookup_port_in_bridge(lagname))
     {
         vty_out(vty, "Failed to add native VLAN. Disable routing on the LAG.%s", VTY_NEWLINE);
         cli_do_config_abort(status_txn);
@@ -2412,14 +2623,7 @@ DEFUN(cli_lag_vlan_trunk_native,
         return CMD_SUCCESS;
     }
 
-    OVSREC_VLAN_FOR_EACH(vlan_row, idl)
-    {
-        if (vlan_row->id == vlan_id)
-        {
-            found_vlan = 1;
-            break;
-        }
-    }
+    found_vlan = (vlan_lookup_vlan(vlan_id) != NULL);
 
     if (found_vlan == 0)
     {
@@ -2428,14 +2632,7 @@ DEFUN(cli_lag_vlan_trunk_native,
         return CMD_SUCCESS;
     }
 
-    OVSREC_PORT_FOR_EACH(port_row, idl)
-    {
-        if (strcmp(port_row->name, lagname) == 0)
-        {
-            vlan_port_row = port_row;
-            break;
-        }
-    }
+    vlan_port_row = vlan_lookup_port(lagname);
 
     if(vlan_port_row == NULL)
     {
@@ -2478,7 +2675,6 @@ DEFUN(cli_lag_no_vlan_trunk_native,
     TRUNK_STR
     "Native VLAN on the trunk port\n")
 {
-    const struct ovsrec_port *port_row = NULL;
     const struct ovsrec_port* vlan_port_row = NULL;
     struct ovsdb_idl_txn *status_txn = cli_do_config_start();
     enum ovsdb_idl_txn_status status;
@@ -2492,21 +2688,14 @@ DEFUN(cli_lag_no_vlan_trunk_native,
     }
 
     char *lagname = (char *) vty->index;
-    if (!check_port_in_bridge(lagname))
+    if (!vlan_lookup_port_in_bridge(lagname))
     {
         vty_out(vty, "Failed to remove native VLAN. Disable routing on the LAG.%s", VTY_NEWLINE);
         cli_do_config_abort(status_txn);
         return CMD_SUCCESS;
     }
 
-    OVSREC_PORT_FOR_EACH(port_row, idl)
-    {
-        if (strcmp(port_row->name, lagname) == 0)
-        {
-            vlan_port_row = port_row;
-            break;
-        }
-    }
+    vlan_port_row = vlan_lookup_port(lagname);
 
     if (vlan_port_row->vlan_mode != NULL &&
         strcmp(vlan_port_row->vlan_mode, OVSREC_PORT_VLAN_MODE_NATIVE_TAGGED) != 0 &&
@@ -2550,7 +2739,6 @@ DEFUN(cli_lag_vlan_trunk_native_tag,
     "Native VLAN on the trunk port\n"
     "Tag configuration on the trunk port\n")
 {
-    const struct ovsrec_port *port_row = NULL;
     const struct ovsrec_port *vlan_port_row = NULL;
     struct ovsdb_idl_txn *status_txn = cli_do_config_start();
     enum ovsdb_idl_txn_status status;
@@ -2564,21 +2752,14 @@ DEFUN(cli_lag_vlan_trunk_native_tag,
     }
 
     char *lagname = (char *) vty->index;
-    if (!check_port_in_bridge(lagname))
+    if (!vlan_lookup_port_in_bridge(lagname))
     {
         vty_out(vty, "Failed to set native VLAN tagging. Disable routing on the LAG.%s", VTY_NEWLINE);
         cli_do_config_abort(status_txn);
         return CMD_SUCCESS;
     }
 
-    OVSREC_PORT_FOR_EACH(port_row, idl)
-    {
-        if (strcmp(port_row->name, lagname) == 0)
-        {
-            vlan_port_row = port_row;
-            break;
-        }
-    }
+    vlan_port_row = vlan_lookup_port(lagname);
 
     if(vlan_port_row == NULL)
     {
@@ -2620,7 +2801,6 @@ DEFUN(cli_lag_no_vlan_trunk_native_tag,
     "Native VLAN on the trunk port\n"
     "Tag configuration on the trunk port\n")
 {
-    const struct ovsrec_port *port_row = NULL;
     const struct ovsrec_port *vlan_port_row = NULL;
     struct ovsdb_idl_txn *status_txn = cli_do_config_start();
     enum ovsdb_idl_txn_status status;
@@ -2634,21 +2814,14 @@ DEFUN(cli_lag_no_vlan_trunk_native_tag,
     }
 
     char *lagname = (char *) vty->index;
-    if (!check_port_in_bridge(lagname))
+    if (!vlan_lookup_port_in_bridge(lagname))
     {
         vty_out(vty, "Failed to remove native VLAN tagging. Disable routing on the LAG.%s", VTY_NEWLINE);
         cli_do_config_abort(status_txn);
         return CMD_SUCCESS;
     }
 
-    OVSREC_PORT_FOR_EACH(port_row, idl)
-    {
-        if (strcmp(port_row->name, lagname) == 0)
-        {
-            vlan_port_row = port_row;
-            break;
-        }
-    }
+    vlan_port_row = vlan_lookup_port(lagname);
 
     if (vlan_port_row == NULL)
     {
@@ -2706,60 +2879,305 @@ DEFUN(cli_show_vlan_summary,
     return CMD_SUCCESS;
 }
 
-DEFUN(cli_show_vlan,
-    cli_show_vlan_cmd,
-    "show vlan",
-    SHOW_STR
-    SHOW_VLAN_STR)
+/*-----------------------------------------------------------------------------
+ | Function: port_vids
+ | Responsibility: Get the VLANs a port uses, as trunks or as its tag.
+ | Parameters:
+ |      port_row: port to look at.
+ |      vids: bitmap of VLAN_BITMAP_SIZE bits, set to the port's VLAN IDs.
+ ------------------------------------------------------------------------------
+ */
+static void
+port_vids(const struct ovsrec_port *port_row, unsigned long *vids)
+{
+    int64_t vid = 0;
+    int i = 0;
+
+    memset(vids, 0, bitmap_n_bytes(VLAN_BITMAP_SIZE));
+    for (i = 0; i < port_row->n_vlan_trunks; i++)
+    {
+        vid = ops_port_get_trunks(port_row, i);
+        if (vid >= 0 && vid < VLAN_BITMAP_SIZE)
+        {
+            bitmap_set1(vids, vid);
+        }
+    }
+    if (port_row->vlan_tag != NULL)
+    {
+        vid = ops_port_get_tag(port_row);
+        if (vid >= 0 && vid < VLAN_BITMAP_SIZE)
+        {
+            bitmap_set1(vids, vid);
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ | Function: port_uses_vids
+ | Responsibility: Check whether a port uses any of a set of VLANs, as a
+ |                 trunk or as its tag.
+ | Parameters:
+ |      port_row: port to look at.
+ |      vids: bitmap of VLAN_BITMAP_SIZE bits of VLAN IDs.
+ | Return:
+ |      true if the port uses a VLAN in 'vids'.
+ ------------------------------------------------------------------------------
+ */
+static bool
+port_uses_vids(const struct ovsrec_port *port_row, const unsigned long *vids)
+{
+    int64_t vid = 0;
+    int i = 0;
+
+    for (i = 0; i < port_row->n_vlan_trunks; i++)
+    {
+        vid = ops_port_get_trunks(port_row, i);
+        if (vid >= 0 && vid < VLAN_BITMAP_SIZE && bitmap_is_set(vids, vid))
+        {
+            return true;
+        }
+    }
+    if (port_row->vlan_tag != NULL)
+    {
+        vid = ops_port_get_tag(port_row);
+        if (vid >= 0 && vid < VLAN_BITMAP_SIZE && bitmap_is_set(vids, vid))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Ports of each VLAN, by VLAN ID.  The ports of VLAN 'vid' are
+ * ports[start[vid]] up to but excluding ports[start[vid + 1]], in the order
+ * of sort_interface(). */
+struct vlan_port_index {
+    size_t *start;                      /* VLAN_BITMAP_SIZE + 1 entries. */
+    const struct ovsrec_port **ports;
+};
+
+/*-----------------------------------------------------------------------------
+ | Function: vlan_port_index_build
+ | Responsibility: Index the ports that use each VLAN, either as a trunk or
+ |                 as their tag, with one sort of the ports that use any of
+ |                 the VLANs and two passes over them: one to count the ports
+ |                 of each VLAN and one to fill them in.  Since the ports are
+ |                 visited in sorted order, the ports of every VLAN come out
+ |                 sorted.
+ | Parameters:
+ |      index: index to build.  Free with vlan_port_index_destroy().
+ |      vids: bitmap of VLAN_BITMAP_SIZE bits of the VLAN IDs to index.
+ ------------------------------------------------------------------------------
+ */
+static void
+vlan_port_index_build(struct vlan_port_index *index, const unsigned long *vids)
 {
-    const struct ovsrec_vlan *vlan_row = NULL;
     const struct ovsrec_port *port_row = NULL;
-    struct shash sorted_vlan_id;
-    struct shash sorted_interfaces;
-    const struct shash_node **nodes;
-    const struct shash_node **ports;
-    int idx, count, i;
-    int port_count = 0;
-    char *str;
-    str = xmalloc(sizeof(char) * sizeof(long int));
-    const char *l3_port = NULL;
+    const struct shash_node **nodes = NULL;
+    struct shash sorted_ports;
+    size_t *next = NULL;
+    size_t *last = NULL;
+    size_t n_ports = 0;
+    size_t p = 0;
+    int pass = 0;
+    int vid = 0;
+    int i = 0;
 
-    vlan_row = ovsrec_vlan_first(idl);
-    if (vlan_row == NULL)
+    index->start = xcalloc(VLAN_BITMAP_SIZE + 1, sizeof *index->start);
+    index->ports = NULL;
+
+    shash_init(&sorted_ports);
+    OVSREC_PORT_FOR_EACH(port_row, idl)
     {
-        vty_out(vty, "No vlan is configured%s", VTY_NEWLINE);
-        free(str);
-        return CMD_SUCCESS;
+        if (port_uses_vids(port_row, vids))
+        {
+            shash_add(&sorted_ports, port_row->name, (void *)port_row);
+        }
+    }
+    n_ports = shash_count(&sorted_ports);
+    if (n_ports == 0)
+    {
+        shash_destroy(&sorted_ports);
+        return;
     }
+    nodes = sort_interface(&sorted_ports);
 
-    vty_out(vty, "%s", VTY_NEWLINE);
-    vty_out(vty, "--------------------------------------------------------------------------------------%s", VTY_NEWLINE);
-    vty_out(vty, "VLAN    Name            Status   Reason         Reserved       Interfaces%s", VTY_NEWLINE);
-    vty_out(vty, "--------------------------------------------------------------------------------------%s", VTY_NEWLINE);
+    /* 'last[vid]' is one more than the index of the last port counted for
+     * 'vid', so that a VLAN that is both a trunk and the tag of a port, or
+     * a repeated trunk, counts the port once. */
+    last = xmalloc(VLAN_BITMAP_SIZE * sizeof *last);
+    next = xmalloc(VLAN_BITMAP_SIZE * sizeof *next);
+    for (pass = 0; pass < 2; pass++)
+    {
+        memset(last, 0, VLAN_BITMAP_SIZE * sizeof *last);
+        for (p = 0; p < n_ports; p++)
+        {
+            port_row = nodes[p]->data;
+            for (i = 0; i <= port_row->n_vlan_trunks; i++)
+            {
+                if (i < port_row->n_vlan_trunks)
+                {
+                    vid = ops_port_get_trunks(port_row, i);
+                }
+                else if (port_row->vlan_tag != NULL)
+                {
+                    vid = ops_port_get_tag(port_row);
+                }
+                else
+                {
+                    break;
+                }
+
+                if (vid < 0 || vid >= VLAN_BITMAP_SIZE || last[vid] == p + 1
+                    || !bitmap_is_set(vids, vid))
+                {
+                    continue;
+                }
+                last[vid] = p + 1;
+
+                if (pass == 0)
+                {
+                    index->start[vid + 1]++;
+                }
+                else
+                {
+                    index->ports[next[vid]++] = port_row;
+                }
+            }
+        }
 
-    shash_init(&sorted_vlan_id);
+        if (pass == 0)
+        {
+            for (vid = 0; vid < VLAN_BITMAP_SIZE; vid++)
+            {
+                index->start[vid + 1] += index->start[vid];
+                next[vid] = index->start[vid];
+            }
+            index->ports = xmalloc((index->start[VLAN_BITMAP_SIZE] + 1)
+                                   * sizeof *index->ports);
+        }
+    }
 
-    OVSREC_VLAN_FOR_EACH(vlan_row, idl)
+    free(next);
+    free(last);
+    free(nodes);
+    shash_destroy(&sorted_ports);
+}
+
+/*-----------------------------------------------------------------------------
+ | Function: vlan_port_index_destroy
+ | Responsibility: Free an index built by vlan_port_index_build().
+ | Parameters:
+ |      index: index to free.
+ ------------------------------------------------------------------------------
+ */
+static void
+vlan_port_index_destroy(struct vlan_port_index *index)
+{
+    free(index->start);
+    free(index->ports);
+}
+
+/* Ports of every VLAN, as of IDL seqno 'vlan_ports_seqno'.  Like the lookup
+ * tables, the index is built on first use and rebuilt only when the IDL
+ * changes, so that a run of "show vlan" commands indexes the ports once. */
+static struct vlan_port_index vlan_ports;
+static bool vlan_ports_valid;
+static unsigned int vlan_ports_seqno;
+
+/*-----------------------------------------------------------------------------
+ | Function: vlan_ports_get
+ | Responsibility: Get the index of the ports of every VLAN, rebuilding it
+ |                 if the IDL has changed since it was last built.
+ | Return:
+ |      The index.
+ ------------------------------------------------------------------------------
+ */
+static const struct vlan_port_index *
+vlan_ports_get(void)
+{
+    const struct vlan_lookup *lookup = vlan_lookup_get();
+
+    if (vlan_ports_valid && vlan_ports_seqno == lookup->seqno)
     {
-        sprintf(str, "%ld", vlan_row->id);
-        shash_add(&sorted_vlan_id, str, (void *)vlan_row);
+        return &vlan_ports;
     }
 
-    OVSREC_PORT_FOR_EACH(port_row, idl)
+    if (vlan_ports_valid)
+    {
+        vlan_port_index_destroy(&vlan_ports);
+    }
+    vlan_port_index_build(&vlan_ports, lookup->vlan_ids);
+    vlan_ports_valid = true;
+    vlan_ports_seqno = lookup->seqno;
+
+    return &vlan_ports;
+}
+
+/*-----------------------------------------------------------------------------
+ | Function: show_vlans
+ | Responsibility: Print a table of the VLANs that match a filter, in VLAN
+ |                 ID order.  The VLANs are found by ID in the lookup
+ |                 tables and their ports in the VLAN port index, so the
+ |                 work is in proportion to what is printed, apart from
+ |                 rebuilding the tables and the index once after each
+ |                 database change.  Each row is printed as soon as it is
+ |                 formatted.
+ | Parameters:
+ |      vty: terminal to print on.
+ |      vids: bitmap of VLAN_BITMAP_SIZE bits of the VLAN IDs to print, or
+ |            NULL for all VLANs.
+ |      state: operational state of the VLANs to print, or NULL for any.
+ | Return:
+ |      The number of VLANs printed.  Nothing, not even the table header,
+ |      is printed if no VLAN matches.
+ ------------------------------------------------------------------------------
+ */
+static size_t
+show_vlans(struct vty *vty, const unsigned long *vids, const char *state)
+{
+    const struct vlan_lookup *lookup = NULL;
+    const struct vlan_port_index *index = NULL;
+    const struct ovsrec_vlan *vlan_row = NULL;
+    unsigned long selected[BITMAP_N_LONGS(VLAN_BITMAP_SIZE)];
+    const char *l3_port = NULL;
+    size_t n_vlans = 0;
+    size_t i;
+    int vid;
+
+    lookup = vlan_lookup_get();
+    for (i = 0; i < BITMAP_N_LONGS(VLAN_BITMAP_SIZE); i++)
+    {
+        selected[i] = lookup->vlan_ids[i] & (vids ? vids[i] : ~0UL);
+    }
+    BITMAP_FOR_EACH_1(vid, VLAN_BITMAP_SIZE, selected)
+    {
+        vlan_row = lookup->vlans[vid];
+        if (state && (vlan_row->oper_state == NULL
+                      || strcmp(vlan_row->oper_state, state) != 0))
+        {
+            bitmap_set0(selected, vid);
+            continue;
+        }
+        n_vlans++;
+    }
+
+    if (n_vlans == 0)
     {
-        if(port_row->vlan_tag != NULL || port_row->n_vlan_trunks != 0)
-            port_count++;
+        return 0;
     }
 
-    nodes = sort_vlan_id(&sorted_vlan_id);
-    count = shash_count(&sorted_vlan_id);
-    for (idx = 0; idx < count; idx++)
+    vty_out(vty, "%s", VTY_NEWLINE);
+    vty_out(vty, "--------------------------------------------------------------------------------------%s", VTY_NEWLINE);
+    vty_out(vty, "VLAN    Name            Status   Reason         Reserved       Interfaces%s", VTY_NEWLINE);
+    vty_out(vty, "--------------------------------------------------------------------------------------%s", VTY_NEWLINE);
+
+    index = vlan_ports_get();
+    BITMAP_FOR_EACH_1(vid, VLAN_BITMAP_SIZE, selected)
     {
-        shash_init(&sorted_interfaces);
-        vlan_row = (const struct ovsrec_vlan *)nodes[idx]->data;
-        struct ovsrec_port **port_nodes = NULL;
-        int n = 0;
         char vlan_id[5] = { 0 };
+
+        vlan_row = lookup->vlans[vid];
         snprintf(vlan_id, 5, "%ld", vlan_row->id);
         vty_out(vty, "%-8s", vlan_id);
         vty_out(vty, "%-16s", vlan_row->name);
@@ -2769,166 +3187,118 @@ DEFUN(cli_show_vlan,
             vty_out(vty, "%-15s", "l3port");
         else
             vty_out(vty, "%-15s", "");
-        int count = 0, print_tag = 0;
-        port_row = ovsrec_port_first(idl);
-
-        port_nodes = xmalloc(port_count * sizeof (struct ovsrec_port));
-        if (port_row != NULL)
-        {
-            OVSREC_PORT_FOR_EACH(port_row, idl)
-            {
-                print_tag = 0;
-                for (i = 0; i < port_row->n_vlan_trunks; i++)
-                {
-                    if (vlan_row->id == ops_port_get_trunks(port_row, i))
-                    {
-                        if (port_row->vlan_tag != NULL && ops_port_get_tag(port_row) == vlan_row->id)
-                        {
-                            print_tag = 1;
-                        }
-                        port_nodes[n++] = (struct ovsrec_port *)port_row;
-                        break;
-                    }
-                }
-                if (print_tag == 0 && port_row->vlan_tag != NULL && ops_port_get_tag(port_row) == vlan_row->id)
-                {
-                    port_nodes[n++] = (struct ovsrec_port *)port_row;
-                }
-            }
-        }
 
         if ((l3_port = smap_get(&vlan_row->internal_usage, VLAN_INTERNAL_USAGE_L3PORT)) != NULL)
         {
             vty_out(vty, "%s", l3_port);
         }
 
-        if(n > 0)
+        for (i = index->start[vid]; i < index->start[vid + 1]; i++)
         {
-            for(i = 0; i < n; i++)
-             {
-                 shash_add(&sorted_interfaces,
-                          (const char *)port_nodes[i]->name, (void *)port_row);
-             }
-             ports = sort_interface(&sorted_interfaces);
-             count = shash_count(&sorted_interfaces);
-
-             for(int id = 0; id < count; id++)
-             {
-                 if(id != count-1)
-                     vty_out(vty, "%s, ", ports[id]->name);
-                 else
-                     vty_out(vty, "%s", ports[id]->name);
-             }
-             free(ports);
+            if (i != index->start[vid])
+                vty_out(vty, ", ");
+            vty_out(vty, "%s", index->ports[i]->name);
         }
-        shash_destroy(&sorted_interfaces);
-        free(port_nodes);
         vty_out(vty, "%s", VTY_NEWLINE);
     }
-    shash_destroy(&sorted_vlan_id);
-    free(nodes);
-    free(str);
+
+    return n_vlans;
+}
+
+DEFUN(cli_show_vlan,
+    cli_show_vlan_cmd,
+    "show vlan",
+    SHOW_STR
+    SHOW_VLAN_STR)
+{
+    if (show_vlans(vty, NULL, NULL) == 0)
+    {
+        vty_out(vty, "No vlan is configured%s", VTY_NEWLINE);
+    }
 
     return CMD_SUCCESS;
 }
 
 DEFUN(cli_show_vlan_id,
     cli_show_vlan_id_cmd,
-    "show vlan <1-4094>",
+    "show vlan <A:1-4094>",
     SHOW_STR
     SHOW_VLAN_STR
-    "VLAN identifier\n")
+    "VLAN identifier, or range of VLANs to show. [2, 2-10 or 2,3,4 or 2,3-10]\n")
 {
-    const struct ovsrec_vlan *vlan_row = NULL;
-    const struct ovsrec_vlan *temp_vlan_row = NULL;
-    const struct ovsrec_port *port_row = NULL;
-    int vlan_id = atoi((char*) argv[0]);
-    int i = 0;
-    const char *l3_port = NULL;
+    unsigned long vids[BITMAP_N_LONGS(VLAN_BITMAP_SIZE)];
 
-    vlan_row = ovsrec_vlan_first(idl);
-    if (vlan_row == NULL)
+    if (!vlan_range_parse(argv[0], vids))
     {
-        vty_out(vty, "No vlan is configured%s", VTY_NEWLINE);
-        return CMD_SUCCESS;
+        return CMD_ERR_NO_MATCH;
     }
 
-    OVSREC_VLAN_FOR_EACH(vlan_row, idl)
+    if (ovsrec_vlan_first(idl) == NULL)
     {
-        if (vlan_row->id == vlan_id)
-        {
-            temp_vlan_row = vlan_row;
-            break;
-        }
+        vty_out(vty, "No vlan is configured%s", VTY_NEWLINE);
+        return CMD_SUCCESS;
     }
 
-    if (temp_vlan_row == NULL)
+    if (show_vlans(vty, vids, NULL) == 0)
     {
-        vty_out(vty, "VLAN %d has not been configured%s", vlan_id, VTY_NEWLINE);
-        return CMD_SUCCESS;
+        if (strpbrk(argv[0], ",-"))
+            vty_out(vty, "No VLAN in %s has been configured%s", argv[0], VTY_NEWLINE);
+        else
+            vty_out(vty, "VLAN %s has not been configured%s", argv[0], VTY_NEWLINE);
     }
 
-    vty_out(vty, "%s", VTY_NEWLINE);
-    vty_out(vty, "--------------------------------------------------------------------------------------%s", VTY_NEWLINE);
-    vty_out(vty, "VLAN    Name            Status   Reason         Reserved       Interfaces%s", VTY_NEWLINE);
-    vty_out(vty, "--------------------------------------------------------------------------------------%s", VTY_NEWLINE);
+    return CMD_SUCCESS;
+}
 
+DEFUN(cli_show_vlan_status,
+    cli_show_vlan_status_cmd,
+    "show vlan status (up|down)",
+    SHOW_STR
+    SHOW_VLAN_STR
+    "VLANs in an operational state\n"
+    "VLANs that are operationally up\n"
+    "VLANs that are operationally down\n")
+{
+    const char *state = (strcmp(argv[0], "up") == 0
+                         ? OVSREC_VLAN_OPER_STATE_UP
+                         : OVSREC_VLAN_OPER_STATE_DOWN);
 
-    vty_out(vty, "%-8s", argv[0]);
-    vty_out(vty, "%-16s", temp_vlan_row->name);
-    vty_out(vty, "%-9s", temp_vlan_row->oper_state);
-    vty_out(vty, "%-15s", temp_vlan_row->oper_state_reason);
-    if(!smap_is_empty(&temp_vlan_row->internal_usage))
-        vty_out(vty, "%-15s", "l3port");
-    else
-        vty_out(vty, "%-15s", "");
-    int count = 0, print_tag = 0;
-    port_row = ovsrec_port_first(idl);
-    if (port_row != NULL)
+    if (show_vlans(vty, NULL, state) == 0)
     {
-        OVSREC_PORT_FOR_EACH(port_row, idl)
-        {
-            for (i = 0; i < port_row->n_vlan_trunks; i++)
-            {
-                if (vlan_row->id == ops_port_get_trunks(port_row, i))
-                {
-                    if (port_row->vlan_tag != NULL && ops_port_get_tag(port_row) == vlan_row->id)
-                    {
-                        print_tag = 1;
-                    }
-                    if (count == 0)
-                    {
-                        vty_out(vty, "%s", port_row->name);
-                        count++;
-                    }
-                    else
-                    {
-                        vty_out(vty, ", %s", port_row->name);
-                    }
-                }
-            }
-            if (print_tag == 0 && port_row->vlan_tag != NULL && ops_port_get_tag(port_row) == vlan_row->id)
-            {
-                if (count == 0)
-                {
-                    vty_out(vty, "%s", port_row->name);
-                    count++;
-                }
-                else
-                {
-                    vty_out(vty, ", %s", port_row->name);
-                }
-            }
-        }
+        vty_out(vty, "No VLAN is %s%s", state, VTY_NEWLINE);
+    }
 
-        if ((l3_port = smap_get(&vlan_row->internal_usage, VLAN_INTERNAL_USAGE_L3PORT)) != NULL)
-            {
-                vty_out(vty, "%s", l3_port);
-            }
+    return CMD_SUCCESS;
+}
+
+DEFUN(cli_show_vlan_interface,
+    cli_show_vlan_interface_cmd,
+    "show vlan interface IFNAME",
+    SHOW_STR
+    SHOW_VLAN_STR
+    "VLANs of an interface\n"
+    "Interface name\n")
+{
+    const struct ovsrec_port *port_row = NULL;
+    unsigned long vids[BITMAP_N_LONGS(VLAN_BITMAP_SIZE)];
 
+    /* A LAG member interface has the VLANs of its LAG's port. */
+    port_row = vlan_lookup_iface_port(argv[0]);
+    if (port_row == NULL)
+    {
+        port_row = vlan_lookup_port(argv[0]);
+    }
+    if (port_row == NULL)
+    {
+        vty_out(vty, "Interface %s has no VLAN configuration%s", argv[0], VTY_NEWLINE);
+        return CMD_SUCCESS;
     }
 
-    vty_out(vty, "%s", VTY_NEWLINE);
+    port_vids(port_row, vids);
+    if (show_vlans(vty, vids, NULL) == 0)
+    {
+        vty_out(vty, "No VLAN is configured on interface %s%s", argv[0], VTY_NEWLINE);
+    }
 
     return CMD_SUCCESS;
 }
@@ -3006,6 +3376,8 @@ void cli_post_init(void)
     install_element(ENABLE_NODE, &cli_show_vlan_summary_cmd);
     install_element(ENABLE_NODE, &cli_show_vlan_cmd);
     install_element(ENABLE_NODE, &cli_show_vlan_id_cmd);
+    install_element(ENABLE_NODE, &cli_show_vlan_status_cmd);
+    install_element(ENABLE_NODE, &cli_show_vlan_interface_cmd);
 
     install_element(VLAN_NODE, &config_exit_cmd);
     install_element(VLAN_NODE, &config_end_cmd);
@@ -28,6 +28,9 @@
 #include "vtysh/zebra.h"
 #include "vtysh/vty.h"
 #include "vtysh/vector.h"
+#include "bitmap.h"
+#include "dynamic-string.h"
+#include "ovsdb-data.h"
 #include "vswitch-idl.h"
 #include "openswitch-idl.h"
 #include "vtysh/vtysh_ovsdb_if.h"
@@ -37,45 +40,135 @@
 #include "vlan_vty.h"
 #include "smap.h"
 
-static struct shash sorted_vlan_id;
+/* State of one pass of the running-config over the VLAN table, from
+ * vtysh_vlan_context_init() to vtysh_vlan_context_exit().  It is static so
+ * that the pass needs no memory per VLAN. */
+static struct {
+    const struct ovsrec_vlan *rows[VLAN_BITMAP_SIZE];   /* By VLAN ID. */
+    uint16_t last[VLAN_BITMAP_SIZE];    /* Last ID of the block that starts
+                                         * at each ID, or 0. */
+    struct shash_node nodes[VLAN_BITMAP_SIZE];
+    const struct shash_node *sorted[VLAN_BITMAP_SIZE];
+    struct feature_sorted_list list;
+} vlan_context;
 
+/* VLAN columns that this context prints itself, or that hold status rather
+ * than config.  Any other column is left to the subcontexts of other
+ * features, which may print lines under "vlan <id>". */
+static const struct ovsdb_idl_column *const vlan_own_columns[] = {
+   &ovsrec_vlan_col_id,
+   &ovsrec_vlan_col_name,
+   &ovsrec_vlan_col_admin,
+   &ovsrec_vlan_col_description,
+   &ovsrec_vlan_col_internal_usage,
+   &ovsrec_vlan_col_hw_vlan_config,
+   &ovsrec_vlan_col_oper_state,
+   &ovsrec_vlan_col_oper_state_reason,
+};
+
+/*-----------------------------------------------------------------------------
+| Function : vlan_has_default_config
+| Responsibility : Check whether the running-config of a VLAN is just
+|                  "vlan <id>", so that it can share a "vlan <range>" line
+|                  with its neighbours.  Besides the config this context
+|                  prints, every other column of the row must be at its
+|                  default, so that no subcontext has anything to print
+|                  under the VLAN.
+| Parameters :
+|     const struct ovsrec_vlan *vlan_row : VLAN to check
+| Return : true if the VLAN is shut down, has no description, is not
+|          internal and has no config of other features
+-----------------------------------------------------------------------------*/
+static bool
+vlan_has_default_config(const struct ovsrec_vlan *vlan_row)
+{
+   const struct ovsdb_idl_column *column;
+   size_t i, j;
+
+   if (check_if_internal_vlan(vlan_row)
+       || (vlan_row->admin
+           && strcmp(vlan_row->admin, OVSREC_VLAN_ADMIN_UP) == 0)
+       || vlan_row->description != NULL) {
+       return false;
+   }
+
+   for (i = 0; i < ovsrec_table_vlan.n_columns; i++) {
+       column = &ovsrec_table_vlan.columns[i];
+       for (j = 0; j < ARRAY_SIZE(vlan_own_columns); j++) {
+           if (column == vlan_own_columns[j]) {
+               break;
+           }
+       }
+       if (j == ARRAY_SIZE(vlan_own_columns)
+           && !ovsdb_datum_is_default(ovsdb_idl_read(&vlan_row->header_,
+                                                     column),
+                                      &column->type)) {
+           return false;
+       }
+   }
+
+   return true;
+}
+
+/*-----------------------------------------------------------------------------
+| Function : vtysh_vlan_context_init
+| Responsibility : List the VLANs in VLAN ID order for the running-config,
+|                  with one entry per run of consecutive VLANs that have the
+|                  default config, which print as a single "vlan <range>".
+| Parameters :
+|     void *p_private: void type object typecast to required
+| Return : the VLANs to print, valid until vtysh_vlan_context_exit()
+-----------------------------------------------------------------------------*/
 struct feature_sorted_list *
 vtysh_vlan_context_init(void *p_private)
 {
    vtysh_ovsdb_cbmsg_ptr p_msg = (vtysh_ovsdb_cbmsg *)p_private;
    const struct ovsrec_vlan *vlan_row;
-   const struct shash_node **nodes;
-   struct feature_sorted_list *sorted_list = NULL;
-   int count;
-   char vlan_id_str[VLAN_ID_LEN];
-
-   shash_init(&sorted_vlan_id);
+   int count = 0;
+   int vid, last;
 
+   memset(vlan_context.rows, 0, sizeof vlan_context.rows);
+   memset(vlan_context.last, 0, sizeof vlan_context.last);
    OVSREC_VLAN_FOR_EACH(vlan_row, p_msg->idl)
    {
-       snprintf(vlan_id_str, VLAN_ID_LEN, "%ld", vlan_row->id);
-       shash_add(&sorted_vlan_id, vlan_id_str, (void *)vlan_row);
+       if (vlan_row->id >= 0 && vlan_row->id < VLAN_BITMAP_SIZE) {
+           vlan_context.rows[vlan_row->id] = vlan_row;
+       }
    }
 
-   nodes = sort_vlan_id(&sorted_vlan_id);
-   count = shash_count(&sorted_vlan_id);
+   for (vid = 0; vid < VLAN_BITMAP_SIZE; vid = last + 1)
+   {
+       vlan_row = vlan_context.rows[vid];
+       last = vid;
+       if (vlan_row == NULL) {
+           continue;
+       }
 
-   sorted_list = (struct feature_sorted_list *)
-                 malloc (sizeof(struct feature_sorted_list));
-   if (sorted_list != NULL) {
-       sorted_list->nodes = nodes;
-       sorted_list->count = count;
+       if (vlan_has_default_config(vlan_row)) {
+           while (last + 1 < VLAN_BITMAP_SIZE
+                  && vlan_context.rows[last + 1] != NULL
+                  && vlan_has_default_config(vlan_context.rows[last + 1])) {
+               last++;
+           }
+       }
+       vlan_context.last[vid] = last;
+
+       vlan_context.nodes[count].name = vlan_row->name;
+       vlan_context.nodes[count].data = (void *)vlan_row;
+       vlan_context.sorted[count] = &vlan_context.nodes[count];
+       count++;
    }
 
-   return sorted_list;
+   vlan_context.list.nodes = vlan_context.sorted;
+   vlan_context.list.count = count;
+
+   return &vlan_context.list;
 }
 
 void
-vtysh_vlan_context_exit(struct feature_sorted_list *list)
+vtysh_vlan_context_exit(struct feature_sorted_list *list OVS_UNUSED)
 {
-   shash_destroy(&sorted_vlan_id);
-   free(list->nodes);
-   free(list);
+   /* Nothing to free: the list is in 'vlan_context'. */
 }
 
 /*-----------------------------------------------------------------------------
@@ -92,7 +185,12 @@ vtysh_vlan_context_clientcallback(void *p_private)
   vtysh_ovsdb_cbmsg_ptr p_msg = (vtysh_ovsdb_cbmsg *)p_private;
   const struct ovsrec_vlan *vlan_row = (struct ovsrec_vlan *)p_msg->feature_row;
 
-  if (!check_if_internal_vlan(vlan_row)) {
+  if (vlan_row->id >= 0 && vlan_row->id < VLAN_BITMAP_SIZE
+      && vlan_context.last[vlan_row->id] > vlan_row->id) {
+        /* A run of VLANs with the default config. */
+        vtysh_ovsdb_cli_print(p_msg, "%s %d-%d", "vlan", vlan_row->id,
+                              vlan_context.last[vlan_row->id]);
+  } else if (!check_if_internal_vlan(vlan_row)) {
         vtysh_ovsdb_cli_print(p_msg, "%s %d", "vlan", vlan_row->id);
         if (strcmp(vlan_row->admin, OVSREC_VLAN_ADMIN_UP) == 0) {
             vtysh_ovsdb_cli_print(p_msg, "%4s%s", "", "no shutdown");
@@ -106,6 +204,73 @@ vtysh_vlan_context_clientcallback(void *p_private)
   return e_vtysh_ok;
 }
 
+/* Longest VLAN list on one "vlan trunk allowed" line.  Ranges are not split
+ * and longer lists go on further lines, which the command adds together. */
+#define VLAN_TRUNK_LINE_MAX 128
+
+/*-----------------------------------------------------------------------------
+| Function : vtysh_ovsdb_intftable_print_trunks
+| Responsibility : Print the trunks of a port as "vlan trunk allowed" lines
+|                  of VLAN ID ranges, e.g. "2-100,200,300-400", rather than
+|                  one line per VLAN.
+| Parameters :
+|     const struct ovsrec_port *port_row : Port whose trunks to print
+|     vtysh_ovsdb_cbmsg_ptr p_msg        : Used for idl operations
+-----------------------------------------------------------------------------*/
+static void
+vtysh_ovsdb_intftable_print_trunks(const struct ovsrec_port *port_row,
+                                   vtysh_ovsdb_cbmsg_ptr p_msg)
+{
+  unsigned long vids[BITMAP_N_LONGS(VLAN_BITMAP_SIZE)];
+  struct ds line = DS_EMPTY_INITIALIZER;
+  int64_t trunk;
+  size_t first, last;
+  int i;
+
+  memset(vids, 0, sizeof vids);
+  for (i = 0; i < port_row->n_vlan_trunks; i++)
+  {
+    trunk = ops_port_get_trunks(port_row, i);
+    if (trunk >= 0 && trunk < VLAN_BITMAP_SIZE)
+    {
+      bitmap_set1(vids, trunk);
+    }
+  }
+
+  for (first = bitmap_scan(vids, true, 0, VLAN_BITMAP_SIZE);
+       first < VLAN_BITMAP_SIZE;
+       first = bitmap_scan(vids, true, last + 1, VLAN_BITMAP_SIZE))
+  {
+    last = bitmap_scan(vids, false, first, VLAN_BITMAP_SIZE) - 1;
+
+    if (line.length >= VLAN_TRUNK_LINE_MAX)
+    {
+      vtysh_ovsdb_cli_print(p_msg, "%4s%s%s", "", "vlan trunk allowed ",
+                            ds_cstr(&line));
+      ds_clear(&line);
+    }
+    if (line.length)
+    {
+      ds_put_char(&line, ',');
+    }
+    if (first == last)
+    {
+      ds_put_format(&line, "%"PRIuSIZE, first);
+    }
+    else
+    {
+      ds_put_format(&line, "%"PRIuSIZE"-%"PRIuSIZE, first, last);
+    }
+  }
+
+  if (line.length)
+  {
+    vtysh_ovsdb_cli_print(p_msg, "%4s%s%s", "", "vlan trunk allowed ",
+                          ds_cstr(&line));
+  }
+  ds_destroy(&line);
+}
+
 /*-----------------------------------------------------------------------------
 | Function : vtysh_ovsdb_intftable_parse_vlan
 | Responsibility : Used for VLAN related config
@@ -119,7 +284,6 @@ vtysh_ovsdb_intftable_parse_vlan(const char *if_name,
                                  vtysh_ovsdb_cbmsg_ptr p_msg)
 {
   const struct ovsrec_port *port_row;
-  int i;
 
   port_row = port_lookup(if_name, p_msg->idl);
   if (port_row == NULL)
@@ -140,11 +304,7 @@ vtysh_ovsdb_intftable_parse_vlan(const char *if_name,
   }
   else if (strcmp(port_row->vlan_mode, OVSREC_PORT_VLAN_MODE_TRUNK) == 0)
   {
-    for (i = 0; i < port_row->n_vlan_trunks; i++)
-    {
-      vtysh_ovsdb_cli_print(p_msg, "%4s%s%d", "", "vlan trunk allowed ",
-                            ops_port_get_trunks(port_row, i));
-    }
+    vtysh_ovsdb_intftable_print_trunks(port_row, p_msg);
   }
   else if (strcmp(port_row->vlan_mode, OVSREC_PORT_VLAN_MODE_NATIVE_UNTAGGED)
            == 0)
@@ -154,11 +314,7 @@ vtysh_ovsdb_intftable_parse_vlan(const char *if_name,
       vtysh_ovsdb_cli_print(p_msg, "%4s%s%d", "", "vlan trunk native ",
                             ops_port_get_tag(port_row));
     }
-    for (i = 0; i < port_row->n_vlan_trunks; i++)
-    {
-      vtysh_ovsdb_cli_print(p_msg, "%4s%s%d", "", "vlan trunk allowed ",
-                            ops_port_get_trunks(port_row, i));
-    }
+    vtysh_ovsdb_intftable_print_trunks(port_row, p_msg);
   }
   else if (strcmp(port_row->vlan_mode, OVSREC_PORT_VLAN_MODE_NATIVE_TAGGED)
            == 0)
@@ -169,11 +325,7 @@ vtysh_ovsdb_intftable_parse_vlan(const char *if_name,
                             ops_port_get_tag(port_row));
     }
     vtysh_ovsdb_cli_print(p_msg, "%4s%s", "", "vlan trunk native tag");
-    for (i = 0; i < port_row->n_vlan_trunks; i++)
-    {
-      vtysh_ovsdb_cli_print(p_msg, "%4s%s%d", "", "vlan trunk allowed ",
-                            ops_port_get_trunks(port_row, i));
-    }
+    vtysh_ovsdb_intftable_print_trunks(port_row, p_msg);
   }
 
   return e_vtysh_ok;
@@ -0,0 +1,467 @@
+/*
+ * (C) Copyright 2016 Hewlett Packard Enterprise Development LP
+ * All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/*************************************************************************//**
+ * @ingroup ops-vland
+ *
+ * @file
+ * Compact set of VLAN IDs.  See vlan_set.h.
+ ****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <util.h>
+
+#include "vland_bitmap.h"
+#include "vlan_set.h"
+
+/* A range list is used only while it is smaller than a bitmap. */
+#define VLAN_SET_MAX_RANGES \
+    (sizeof(struct vland_bitmap) / sizeof(struct vlan_range) - 1)
+
+static inline bool
+vid_in_range(int vid)
+{
+    return vid >= 0 && vid < VLAND_BITMAP_BITS;
+}
+
+/* Frees the heap memory of 'set', leaving it an empty ARRAY set. */
+static void
+vlan_set_free_heap(struct vlan_set *set)
+{
+    if (set->type == VLAN_SET_RANGES) {
+        free(set->u.ranges);
+    } else if (set->type == VLAN_SET_BITMAP) {
+        free_cacheline(set->u.bitmap);
+    }
+    set->type = VLAN_SET_ARRAY;
+    set->count = 0;
+    set->n = 0;
+    set->allocated = 0;
+
+} /* vlan_set_free_heap */
+
+void
+vlan_set_init(struct vlan_set *set)
+{
+    memset(set, 0, sizeof *set);
+    set->type = VLAN_SET_ARRAY;
+
+} /* vlan_set_init */
+
+void
+vlan_set_destroy(struct vlan_set *set)
+{
+    vlan_set_free_heap(set);
+
+} /* vlan_set_destroy */
+
+/* Returns the index of the first element of 'vids[0..n)' that is >= 'vid'. */
+static size_t
+vids_lower_bound(const uint16_t *vids, size_t n, int vid)
+{
+    size_t lo = 0, hi = n;
+
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (vids[mid] < vid) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+
+} /* vids_lower_bound */
+
+/* Returns the index of the first range of 'set' whose last VID is >= 'vid',
+ * or set->n if there is none. */
+static size_t
+ranges_lower_bound(const struct vlan_set *set, int vid)
+{
+    size_t lo = 0, hi = set->n;
+
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (set->u.ranges[mid].last < vid) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+
+} /* ranges_lower_bound */
+
+bool
+vlan_set_contains(const struct vlan_set *set, int vid)
+{
+    size_t i;
+
+    if (!vid_in_range(vid)) {
+        return false;
+    }
+
+    switch (set->type) {
+    case VLAN_SET_ARRAY:
+        i = vids_lower_bound(set->u.vids, set->n, vid);
+        return i < set->n && set->u.vids[i] == vid;
+
+    case VLAN_SET_RANGES:
+        i = ranges_lower_bound(set, vid);
+        return i < set->n && set->u.ranges[i].first <= vid;
+
+    case VLAN_SET_BITMAP:
+        return vland_bitmap_is_set(set->u.bitmap, vid);
+    }
+
+    OVS_NOT_REACHED();
+
+} /* vlan_set_contains */
+
+/* Stores the members of 'set' in 'bitmap'.  'bitmap' is not cleared
+ * first. */
+void
+vlan_set_or_into_bitmap(const struct vlan_set *set,
+                        struct vland_bitmap *bitmap)
+{
+    size_t i;
+    int vid;
+
+    switch (set->type) {
+    case VLAN_SET_ARRAY:
+        for (i = 0; i < set->n; i++) {
+            vland_bitmap_set1(bitmap, set->u.vids[i]);
+        }
+        break;
+
+    case VLAN_SET_RANGES:
+        for (i = 0; i < set->n; i++) {
+            const struct vlan_range *r = &set->u.ranges[i];
+            for (vid = r->first; vid <= r->last; vid++) {
+                vland_bitmap_set1(bitmap, vid);
+            }
+        }
+        break;
+
+    case VLAN_SET_BITMAP:
+        vland_bitmap_or(bitmap, set->u.bitmap);
+        break;
+    }
+
+} /* vlan_set_or_into_bitmap */
+
+/* Replaces the contents of 'set' by the VIDs set in 'bitmap', choosing the
+ * smallest representation that fits them.  Memory already held by 'set' is
+ * reused when it is of the right kind and big enough. */
+void
+vlan_set_from_bitmap(struct vlan_set *set, const struct vland_bitmap *bitmap)
+{
+    size_t count = vland_bitmap_count(bitmap);
+    size_t n_ranges = 0;
+    int vid;
+
+    if (count <= VLAN_SET_MAX_INLINE) {
+        vlan_set_free_heap(set);
+        VLAND_BITMAP_FOR_EACH_1 (vid, bitmap) {
+            set->u.vids[set->n++] = vid;
+        }
+        set->count = count;
+        return;
+    }
+
+    /* Count the runs of consecutive VIDs. */
+    for (vid = vland_bitmap_scan(bitmap, true, 0);
+         vid < VLAND_BITMAP_BITS && n_ranges <= VLAN_SET_MAX_RANGES;
+         vid = vland_bitmap_scan(bitmap, true, vid)) {
+        n_ranges++;
+        vid = vland_bitmap_scan(bitmap, false, vid);
+    }
+
+    if (n_ranges <= VLAN_SET_MAX_RANGES) {
+        size_t i = 0;
+
+        if (set->type != VLAN_SET_RANGES || set->allocated < n_ranges) {
+            vlan_set_free_heap(set);
+            set->u.ranges = xmalloc(n_ranges * sizeof *set->u.ranges);
+            set->allocated = n_ranges;
+            set->type = VLAN_SET_RANGES;
+        }
+        for (vid = vland_bitmap_scan(bitmap, true, 0);
+             vid < VLAND_BITMAP_BITS;
+             vid = vland_bitmap_scan(bitmap, true, vid)) {
+            set->u.ranges[i].first = vid;
+            vid = vland_bitmap_scan(bitmap, false, vid);
+            set->u.ranges[i].last = vid - 1;
+            i++;
+        }
+        set->n = n_ranges;
+    } else {
+        if (set->type != VLAN_SET_BITMAP) {
+            vlan_set_free_heap(set);
+            set->u.bitmap = xmalloc_cacheline(sizeof *set->u.bitmap);
+            set->type = VLAN_SET_BITMAP;
+        }
+        vland_bitmap_copy(set->u.bitmap, bitmap);
+    }
+    set->count = count;
+
+} /* vlan_set_from_bitmap */
+
+/* Adds 'vid' to a RANGES set.  Returns false if the result would need more
+ * ranges than a range list may hold. */
+static bool
+ranges_add(struct vlan_set *set, int vid)
+{
+    struct vlan_range *r = set->u.ranges;
+    size_t i = ranges_lower_bound(set, vid);
+    bool joins_prev = i > 0 && r[i - 1].last + 1 == vid;
+    bool joins_next = i < set->n && r[i].first == vid + 1;
+
+    if (joins_prev && joins_next) {
+        /* 'vid' fills the gap between two ranges. */
+        r[i - 1].last = r[i].last;
+        memmove(&r[i], &r[i + 1], (set->n - i - 1) * sizeof *r);
+        set->n--;
+    } else if (joins_prev) {
+        r[i - 1].last = vid;
+    } else if (joins_next) {
+        r[i].first = vid;
+    } else {
+        if (set->n >= VLAN_SET_MAX_RANGES) {
+            return false;
+        }
+        if (set->n >= set->allocated) {
+            set->allocated = MIN(MAX(set->allocated * 2, 4),
+                                 VLAN_SET_MAX_RANGES);
+            set->u.ranges = xrealloc(set->u.ranges,
+                                     set->allocated * sizeof *r);
+            r = set->u.ranges;
+        }
+        memmove(&r[i + 1], &r[i], (set->n - i) * sizeof *r);
+        r[i].first = r[i].last = vid;
+        set->n++;
+    }
+    return true;
+
+} /* ranges_add */
+
+/* Removes 'vid', which must be a member, from a RANGES set.  Returns false
+ * if the result would need more ranges than a range list may hold. */
+static bool
+ranges_remove(struct vlan_set *set, int vid)
+{
+    struct vlan_range *r = set->u.ranges;
+    size_t i = ranges_lower_bound(set, vid);
+
+    if (r[i].first == vid && r[i].last == vid) {
+        memmove(&r[i], &r[i + 1], (set->n - i - 1) * sizeof *r);
+        set->n--;
+    } else if (r[i].first == vid) {
+        r[i].first++;
+    } else if (r[i].last == vid) {
+        r[i].last--;
+    } else {
+        /* Split the range around 'vid'. */
+        if (set->n >= VLAN_SET_MAX_RANGES) {
+            return false;
+        }
+        if (set->n >= set->allocated) {
+            set->allocated = MIN(set->allocated * 2, VLAN_SET_MAX_RANGES);
+            set->u.ranges = xrealloc(set->u.ranges,
+                                     set->allocated * sizeof *r);
+            r = set->u.ranges;
+        }
+        memmove(&r[i + 1], &r[i], (set->n - i) * sizeof *r);
+        r[i].last = vid - 1;
+        r[i + 1].first = vid + 1;
+        set->n++;
+    }
+    return true;
+
+} /* ranges_remove */
+
+/* Changes 'vid' in 'set' to 'member' through a bitmap, choosing the
+ * representation afresh. */
+static void
+vlan_set_update_slow(struct vlan_set *set, int vid, bool member)
+{
+    struct vland_bitmap bitmap;
+
+    vland_bitmap_zero(&bitmap);
+    vlan_set_or_into_bitmap(set, &bitmap);
+    vland_bitmap_set(&bitmap, vid, member);
+    vlan_set_from_bitmap(set, &bitmap);
+
+} /* vlan_set_update_slow */
+
+void
+vlan_set_add(struct vlan_set *set, int vid)
+{
+    size_t i;
+
+    if (!vid_in_range(vid) || vlan_set_contains(set, vid)) {
+        return;
+    }
+
+    switch (set->type) {
+    case VLAN_SET_ARRAY:
+        if (set->n < VLAN_SET_MAX_INLINE) {
+            i = vids_lower_bound(set->u.vids, set->n, vid);
+            memmove(&set->u.vids[i + 1], &set->u.vids[i],
+                    (set->n - i) * sizeof set->u.vids[0]);
+            set->u.vids[i] = vid;
+            set->n++;
+            set->count++;
+            return;
+        }
+        break;
+
+    case VLAN_SET_RANGES:
+        if (ranges_add(set, vid)) {
+            set->count++;
+            return;
+        }
+        break;
+
+    case VLAN_SET_BITMAP:
+        vland_bitmap_set1(set->u.bitmap, vid);
+        set->count++;
+        return;
+    }
+
+    vlan_set_update_slow(set, vid, true);
+
+} /* vlan_set_add */
+
+void
+vlan_set_remove(struct vlan_set *set, int vid)
+{
+    size_t i;
+
+    if (!vlan_set_contains(set, vid)) {
+        return;
+    }
+
+    switch (set->type) {
+    case VLAN_SET_ARRAY:
+        i = vids_lower_bound(set->u.vids, set->n, vid);
+        memmove(&set->u.vids[i], &set->u.vids[i + 1],
+                (set->n - i - 1) * sizeof set->u.vids[0]);
+        set->n--;
+        set->count--;
+        return;
+
+    case VLAN_SET_RANGES:
+        if (ranges_remove(set, vid)) {
+            set->count--;
+            return;
+        }
+        break;
+
+    case VLAN_SET_BITMAP:
+        vland_bitmap_set0(set->u.bitmap, vid);
+        set->count--;
+        return;
+    }
+
+    vlan_set_update_slow(set, vid, false);
+
+} /* vlan_set_remove */
+
+/* Returns the number of bytes of heap memory used by 'set'. */
+size_t
+vlan_set_heap_bytes(const struct vlan_set *set)
+{
+    switch (set->type) {
+    case VLAN_SET_RANGES:
+        return set->allocated * sizeof *set->u.ranges;
+    case VLAN_SET_BITMAP:
+        return sizeof *set->u.bitmap;
+    case VLAN_SET_ARRAY:
+    default:
+        return 0;
+    }
+
+} /* vlan_set_heap_bytes */
+
+const char *
+vlan_set_type_name(const struct vlan_set *set)
+{
+    switch (set->type) {
+    case VLAN_SET_ARRAY:
+        return "array";
+    case VLAN_SET_RANGES:
+        return "ranges";
+    case VLAN_SET_BITMAP:
+        return "bitmap";
+    }
+    return "unknown";
+
+} /* vlan_set_type_name */
+
+/* Returns the smallest member of 'set', or -1 if it is empty, and sets up
+ * 'iter' for vlan_set_iter_next(). */
+int
+vlan_set_iter_first(struct vlan_set_iter *iter, const struct vlan_set *set)
+{
+    iter->set = set;
+    iter->idx = 0;
+    iter->vid = -1;
+    return vlan_set_iter_next(iter);
+
+} /* vlan_set_iter_first */
+
+/* Returns the next member of the set being iterated, or -1 at the end. */
+int
+vlan_set_iter_next(struct vlan_set_iter *iter)
+{
+    const struct vlan_set *set = iter->set;
+    int vid;
+
+    switch (set->type) {
+    case VLAN_SET_ARRAY:
+        if (iter->idx < set->n) {
+            return iter->vid = set->u.vids[iter->idx++];
+        }
+        break;
+
+    case VLAN_SET_RANGES:
+        while (iter->idx < set->n) {
+            const struct vlan_range *r = &set->u.ranges[iter->idx];
+
+            if (iter->vid < r->first) {
+                return iter->vid = r->first;
+            } else if (iter->vid < r->last) {
+                return ++iter->vid;
+            }
+            iter->idx++;
+        }
+        break;
+
+    case VLAN_SET_BITMAP:
+        vid = vland_bitmap_scan(set->u.bitmap, true, iter->vid + 1);
+        if (vid < VLAND_BITMAP_BITS) {
+            return iter->vid = vid;
+        }
+        break;
+    }
+
+    return iter->vid = -1;
+
+} /* vlan_set_iter_next */
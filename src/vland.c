@@ -64,6 +64,7 @@
 VLOG_DEFINE_THIS_MODULE(ops_vland);
 
 #define VLAND_PID_FILE        "/var/run/openvswitch/ops-vland.pid"
+#define VLAND_MAX_RESYNC_THREADS  64
 
 static void
 vland_unixctl_dump(struct unixctl_conn *conn, int argc OVS_UNUSED,
@@ -111,6 +112,9 @@ usage(void)
     vlog_usage();
     printf("\nOther options:\n"
            "  --unixctl=SOCKET        override default control socket name\n"
+           "  --resync-threads=N      use N threads for a full cache resync\n"
+           "                          (default: 1)\n"
+           "  --pipeline              compute VLAN state on a separate thread\n"
            "  -h, --help              display this help message\n");
     exit(EXIT_SUCCESS);
 
@@ -121,12 +125,16 @@ parse_options(int argc, char *argv[], char **unixctl_pathp)
 {
     enum {
         OPT_UNIXCTL = UCHAR_MAX + 1,
+        OPT_RESYNC_THREADS,
+        OPT_PIPELINE,
         VLOG_OPTION_ENUMS,
         DAEMON_OPTION_ENUMS,
     };
     static const struct option long_options[] = {
         {"help",        no_argument, NULL, 'h'},
         {"unixctl",     required_argument, NULL, OPT_UNIXCTL},
+        {"resync-threads", required_argument, NULL, OPT_RESYNC_THREADS},
+        {"pipeline",    no_argument, NULL, OPT_PIPELINE},
         DAEMON_LONG_OPTIONS,
         VLOG_LONG_OPTIONS,
         {NULL, 0, NULL, 0},
@@ -149,6 +157,22 @@ parse_options(int argc, char *argv[], char **unixctl_pathp)
             *unixctl_pathp = optarg;
             break;
 
+        case OPT_RESYNC_THREADS: {
+            int n_threads;
+
+            if (!str_to_int(optarg, 10, &n_threads)
+                || n_threads < 1 || n_threads > VLAND_MAX_RESYNC_THREADS) {
+                VLOG_FATAL("--resync-threads must be between 1 and %d",
+                           VLAND_MAX_RESYNC_THREADS);
+            }
+            vland_ovsdb_set_resync_threads(n_threads);
+            break;
+        }
+
+        case OPT_PIPELINE:
+            vland_ovsdb_set_pipeline(true);
+            break;
+
         VLOG_OPTION_HANDLERS
         DAEMON_OPTION_HANDLERS
 
@@ -0,0 +1,140 @@
+/*
+ * (C) Copyright 2016 Hewlett Packard Enterprise Development LP
+ * All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/*************************************************************************//**
+ * @ingroup ops-vland
+ *
+ * @file
+ * Bump allocator for per-pass temporary data of the OpenSwitch VLAN daemon.
+ ****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <coverage.h>
+#include <util.h>
+
+#include "vland_arena.h"
+
+/* Number of blocks allocated because a pass outgrew the arena.  This stays
+ * flat once the system is in steady state. */
+COVERAGE_DEFINE(vland_arena_grow);
+
+#define ARENA_ALIGN 16
+
+struct vland_arena_block {
+    struct vland_arena_block *next;
+    size_t size;                 /* Usable bytes in 'data'. */
+    size_t used;                 /* Bytes handed out from 'data'. */
+    char data[] __attribute__((aligned(ARENA_ALIGN)));
+};
+
+static struct vland_arena_block *
+arena_block_create(size_t size)
+{
+    struct vland_arena_block *block = xmalloc(sizeof *block + size);
+
+    COVERAGE_INC(vland_arena_grow);
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+    return block;
+
+} /* arena_block_create */
+
+static void
+arena_free_blocks(struct vland_arena_block *block)
+{
+    while (block) {
+        struct vland_arena_block *next = block->next;
+        free(block);
+        block = next;
+    }
+
+} /* arena_free_blocks */
+
+void
+vland_arena_init(struct vland_arena *arena, size_t block_size)
+{
+    arena->blocks = NULL;
+    arena->block_size = ROUND_UP(block_size, ARENA_ALIGN);
+    arena->high_water = 0;
+    arena->used = 0;
+
+} /* vland_arena_init */
+
+void
+vland_arena_destroy(struct vland_arena *arena)
+{
+    arena_free_blocks(arena->blocks);
+    arena->blocks = NULL;
+    arena->used = 0;
+
+} /* vland_arena_destroy */
+
+void *
+vland_arena_alloc(struct vland_arena *arena, size_t size)
+{
+    struct vland_arena_block *block = arena->blocks;
+    void *p;
+
+    size = ROUND_UP(size ? size : 1, ARENA_ALIGN);
+    if (!block || block->size - block->used < size) {
+        block = arena_block_create(MAX(size, arena->block_size));
+        block->next = arena->blocks;
+        arena->blocks = block;
+    }
+
+    p = block->data + block->used;
+    block->used += size;
+    arena->used += size;
+    return p;
+
+} /* vland_arena_alloc */
+
+void *
+vland_arena_zalloc(struct vland_arena *arena, size_t size)
+{
+    void *p = vland_arena_alloc(arena, size);
+
+    memset(p, 0, size);
+    return p;
+
+} /* vland_arena_zalloc */
+
+void
+vland_arena_reset(struct vland_arena *arena)
+{
+    struct vland_arena_block *block = arena->blocks;
+
+    arena->high_water = MAX(arena->high_water, arena->used);
+    arena->used = 0;
+    if (!block) {
+        return;
+    }
+
+    if (block->next) {
+        /* This pass did not fit in one block.  Replace all blocks with one
+         * that fits the biggest pass so far. */
+        arena_free_blocks(block);
+        arena->block_size = MAX(arena->block_size, arena->high_water);
+        arena->blocks = arena_block_create(arena->block_size);
+    } else {
+        block->used = 0;
+    }
+
+} /* vland_arena_reset */
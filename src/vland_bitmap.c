@@ -0,0 +1,311 @@
+/*
+ * (C) Copyright 2016 Hewlett Packard Enterprise Development LP
+ * All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/*************************************************************************//**
+ * @ingroup ops-vland
+ *
+ * @file
+ * Fixed-size VLAN bitmap kernels.  See vland_bitmap.h.
+ ****************************************************************************/
+
+#include <stdint.h>
+
+#include <util.h>
+#include <vlan-bitmap.h>
+
+#include "vland_bitmap.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define VLAND_BITMAP_X86 1
+#include <immintrin.h>
+#endif
+
+BUILD_ASSERT_DECL(VLAND_BITMAP_BITS == VLAN_BITMAP_SIZE);
+BUILD_ASSERT_DECL(sizeof(struct vland_bitmap) % 32 == 0);
+
+struct vland_bitmap_impl {
+    const char *name;
+    void (*or)(struct vland_bitmap *, const struct vland_bitmap *);
+    void (*andnot)(struct vland_bitmap *, const struct vland_bitmap *);
+    bool (*xor)(struct vland_bitmap *, const struct vland_bitmap *,
+                const struct vland_bitmap *);
+    size_t (*count)(const struct vland_bitmap *);
+};
+
+/**********************************************************************/
+/*                              Portable                              */
+/**********************************************************************/
+static void
+or_scalar(struct vland_bitmap *dst, const struct vland_bitmap *src)
+{
+    size_t i;
+
+    for (i = 0; i < VLAND_BITMAP_LONGS; i++) {
+        dst->bits[i] |= src->bits[i];
+    }
+
+} /* or_scalar */
+
+static void
+andnot_scalar(struct vland_bitmap *dst, const struct vland_bitmap *src)
+{
+    size_t i;
+
+    for (i = 0; i < VLAND_BITMAP_LONGS; i++) {
+        dst->bits[i] &= ~src->bits[i];
+    }
+
+} /* andnot_scalar */
+
+static bool
+xor_scalar(struct vland_bitmap *delta, const struct vland_bitmap *a,
+           const struct vland_bitmap *b)
+{
+    unsigned long any = 0;
+    size_t i;
+
+    for (i = 0; i < VLAND_BITMAP_LONGS; i++) {
+        delta->bits[i] = a->bits[i] ^ b->bits[i];
+        any |= delta->bits[i];
+    }
+    return any != 0;
+
+} /* xor_scalar */
+
+static size_t
+count_scalar(const struct vland_bitmap *b)
+{
+    size_t count = 0;
+    size_t i;
+
+    for (i = 0; i < VLAND_BITMAP_LONGS; i++) {
+        count += __builtin_popcountl(b->bits[i]);
+    }
+    return count;
+
+} /* count_scalar */
+
+static const struct vland_bitmap_impl impl_scalar = {
+    "scalar", or_scalar, andnot_scalar, xor_scalar, count_scalar,
+};
+
+#ifdef VLAND_BITMAP_X86
+/**********************************************************************/
+/*                               POPCNT                               */
+/**********************************************************************/
+/* Population count with the POPCNT instruction, which CPUs add alongside
+ * SSE4.2.  OR, AND-NOT and XOR stay scalar: x86-64 always has SSE2, and
+ * the compiler already vectorizes the portable loops with it. */
+__attribute__((target("popcnt")))
+static size_t
+count_popcnt(const struct vland_bitmap *b)
+{
+    size_t count = 0;
+    size_t i;
+
+    for (i = 0; i < VLAND_BITMAP_LONGS; i++) {
+        count += __builtin_popcountl(b->bits[i]);
+    }
+    return count;
+
+} /* count_popcnt */
+
+static const struct vland_bitmap_impl impl_popcnt = {
+    "scalar+popcnt", or_scalar, andnot_scalar, xor_scalar, count_popcnt,
+};
+
+/**********************************************************************/
+/*                                AVX2                                */
+/**********************************************************************/
+#define AVX2_VECS (sizeof(struct vland_bitmap) / sizeof(__m256i))
+
+__attribute__((target("avx2")))
+static void
+or_avx2(struct vland_bitmap *dst, const struct vland_bitmap *src)
+{
+    __m256i *d = (__m256i *) dst->bits;
+    const __m256i *s = (const __m256i *) src->bits;
+    size_t i;
+
+    for (i = 0; i < AVX2_VECS; i++) {
+        _mm256_store_si256(&d[i], _mm256_or_si256(_mm256_load_si256(&d[i]),
+                                                  _mm256_load_si256(&s[i])));
+    }
+
+} /* or_avx2 */
+
+__attribute__((target("avx2")))
+static void
+andnot_avx2(struct vland_bitmap *dst, const struct vland_bitmap *src)
+{
+    __m256i *d = (__m256i *) dst->bits;
+    const __m256i *s = (const __m256i *) src->bits;
+    size_t i;
+
+    for (i = 0; i < AVX2_VECS; i++) {
+        _mm256_store_si256(&d[i],
+                           _mm256_andnot_si256(_mm256_load_si256(&s[i]),
+                                               _mm256_load_si256(&d[i])));
+    }
+
+} /* andnot_avx2 */
+
+__attribute__((target("avx2")))
+static bool
+xor_avx2(struct vland_bitmap *delta, const struct vland_bitmap *a,
+         const struct vland_bitmap *b)
+{
+    __m256i *d = (__m256i *) delta->bits;
+    const __m256i *x = (const __m256i *) a->bits;
+    const __m256i *y = (const __m256i *) b->bits;
+    __m256i any = _mm256_setzero_si256();
+    size_t i;
+
+    for (i = 0; i < AVX2_VECS; i++) {
+        __m256i v = _mm256_xor_si256(_mm256_load_si256(&x[i]),
+                                     _mm256_load_si256(&y[i]));
+        _mm256_store_si256(&d[i], v);
+        any = _mm256_or_si256(any, v);
+    }
+    return !_mm256_testz_si256(any, any);
+
+} /* xor_avx2 */
+
+/* Counts bits a nibble at a time with a 16-entry table lookup in each byte
+ * lane, then sums the bytes with SAD against zero. */
+__attribute__((target("avx2")))
+static size_t
+count_avx2(const struct vland_bitmap *b)
+{
+    const __m256i *s = (const __m256i *) b->bits;
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3,
+                                           1, 2, 2, 3, 2, 3, 3, 4,
+                                           0, 1, 1, 2, 1, 2, 2, 3,
+                                           1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0f);
+    __m256i sum = _mm256_setzero_si256();
+    uint64_t lanes[4];
+    size_t i;
+
+    for (i = 0; i < AVX2_VECS; i++) {
+        __m256i v = _mm256_load_si256(&s[i]);
+        __m256i lo = _mm256_and_si256(v, low_mask);
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+        __m256i cnt = _mm256_add_epi8(_mm256_shuffle_epi8(table, lo),
+                                      _mm256_shuffle_epi8(table, hi));
+        sum = _mm256_add_epi64(sum,
+                               _mm256_sad_epu8(cnt, _mm256_setzero_si256()));
+    }
+    _mm256_storeu_si256((__m256i *) lanes, sum);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+
+} /* count_avx2 */
+
+static const struct vland_bitmap_impl impl_avx2 = {
+    "avx2", or_avx2, andnot_avx2, xor_avx2, count_avx2,
+};
+#endif /* VLAND_BITMAP_X86 */
+
+static const struct vland_bitmap_impl *impl = &impl_scalar;
+
+const char *
+vland_bitmap_init(void)
+{
+#ifdef VLAND_BITMAP_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        impl = &impl_avx2;
+    } else if (__builtin_cpu_supports("popcnt")) {
+        impl = &impl_popcnt;
+    }
+#endif
+    return impl->name;
+
+} /* vland_bitmap_init */
+
+const char *
+vland_bitmap_impl_name(void)
+{
+    return impl->name;
+
+} /* vland_bitmap_impl_name */
+
+void
+vland_bitmap_or(struct vland_bitmap *dst, const struct vland_bitmap *src)
+{
+    impl->or(dst, src);
+
+} /* vland_bitmap_or */
+
+void
+vland_bitmap_andnot(struct vland_bitmap *dst, const struct vland_bitmap *src)
+{
+    impl->andnot(dst, src);
+
+} /* vland_bitmap_andnot */
+
+bool
+vland_bitmap_xor(struct vland_bitmap *delta, const struct vland_bitmap *a,
+                 const struct vland_bitmap *b)
+{
+    return impl->xor(delta, a, b);
+
+} /* vland_bitmap_xor */
+
+size_t
+vland_bitmap_count(const struct vland_bitmap *b)
+{
+    return impl->count(b);
+
+} /* vland_bitmap_count */
+
+bool
+vland_bitmap_is_empty(const struct vland_bitmap *b)
+{
+    size_t i;
+
+    for (i = 0; i < VLAND_BITMAP_LONGS; i++) {
+        if (b->bits[i]) {
+            return false;
+        }
+    }
+    return true;
+
+} /* vland_bitmap_is_empty */
+
+/* Finds set (or, with 'target' false, clear) bits a word at a time. */
+int
+vland_bitmap_scan(const struct vland_bitmap *b, bool target, int start)
+{
+    unsigned long flip = target ? 0 : ~0UL;
+    size_t i = start / VLAND_BITMAP_ULONG_BITS;
+    unsigned long word;
+
+    if (start >= VLAND_BITMAP_BITS) {
+        return VLAND_BITMAP_BITS;
+    }
+
+    word = (b->bits[i] ^ flip) & (~0UL << (start % VLAND_BITMAP_ULONG_BITS));
+    while (!word) {
+        if (++i >= VLAND_BITMAP_LONGS) {
+            return VLAND_BITMAP_BITS;
+        }
+        word = b->bits[i] ^ flip;
+    }
+    return i * VLAND_BITMAP_ULONG_BITS + __builtin_ctzl(word);
+
+} /* vland_bitmap_scan */
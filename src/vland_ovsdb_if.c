@@ -24,55 +24,109 @@
  ****************************************************************************/
 
 #define _GNU_SOURCE
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
+#include <coverage.h>
 #include <dynamic-string.h>
+#include <poll-loop.h>
+#include <timeval.h>
 #include <vswitch-idl.h>
 #include <openswitch-idl.h>
 #include <openvswitch/vlog.h>
 #include <hash.h>
-#include <shash.h>
-#include <bitmap.h>
-#include <vlan-bitmap.h>
+#include <hmap.h>
+#include <util.h>
+#include <uuid.h>
 #include "vland.h"
+#include "vland_arena.h"
+#include "vland_bitmap.h"
+#include "vland_oper_state.h"
+#include "vland_pipeline.h"
+#include "vland_pool.h"
+#include "vland_workers.h"
+#include "vlan_set.h"
 #include "ops-utils.h"
 
 VLOG_DEFINE_THIS_MODULE(vland_ovsdb_if);
 
+COVERAGE_DEFINE(vland_txn_commit);
+COVERAGE_DEFINE(vland_txn_conflict);
+COVERAGE_DEFINE(vland_txn_error);
+COVERAGE_DEFINE(vland_wakeup_work);
+COVERAGE_DEFINE(vland_wakeup_noop);
+COVERAGE_DEFINE(vland_reconcile);
+COVERAGE_DEFINE(vland_port_recompute);
+COVERAGE_DEFINE(vland_port_unchanged);
+COVERAGE_DEFINE(vland_vlan_unchanged);
+COVERAGE_DEFINE(vland_resync);
+COVERAGE_DEFINE(vland_pipeline_change);
+COVERAGE_DEFINE(vland_pipeline_backlog);
+COVERAGE_DEFINE(vland_pipeline_stale_delta);
+
 #define VALID_VID(x)  ((x)>0 && (x)<4095)
-#define DEFAULT_VID  (1)
+#define DEFAULT_VID  VLAND_DEFAULT_VID
+
+/* Bounds for the exponential backoff applied to failed status commits. */
+#define TXN_BACKOFF_MIN_MSEC  100
+#define TXN_BACKOFF_MAX_MSEC  5000
 
 /**************************************************************************//**
  * port_data struct that contains PORT table information for a single port.
+ * Entries come from 'port_pool'.  The whole entry fits in one cache line;
+ * only ports whose VLANs do not fit inline in 'vlans' use heap memory.
+ *
+ * Ports are keyed by the UUID of their row, which never changes, so a
+ * renamed port keeps its entry.  The name is read from the row when needed.
  *****************************************************************************/
 struct port_data {
-    char *name;
-    enum ovsrec_port_vlan_mode_e vlan_mode;  /*!< "vlan_mode" column. */
-    int native_vid;               /*!< "tag" column - native VLAN ID. */
+    struct hmap_node node;        /*!< In all_ports, hashed on 'uuid'. */
+    struct uuid uuid;             /*!< UUID of the port's row. */
+    uint8_t vlan_mode;            /*!< "vlan_mode" column, an
+                                       enum ovsrec_port_vlan_mode_e. */
     bool trunk_all_vlans;         /*!< Indicates whether this port is
                                        implicitly trunking all VLANs
                                        defined in VLAN table. */
-    unsigned long *vlans_bitmap;  /*!< 'trunks' column - bitmap of
-                                       VLANs in which this port is
-                                       a member. */
+
+    /* Remaining inputs 'vlans' was built from.  Used to tell whether
+     * a reloaded row really changed; see port_vlan_inputs_unchanged(). */
+    bool in_bridge;               /*!< Port is in a bridge. */
+    bool native_in_trunks;        /*!< 'tag' is also in 'trunks'. */
+    int16_t native_vid;           /*!< "tag" column - native VLAN ID. */
+    uint16_t n_trunks;            /*!< Number of 'trunks' used. */
+
+    struct vlan_set vlans;        /*!< 'trunks' column - set of VLANs in
+                                       which this port is a member. */
 };
+BUILD_ASSERT_DECL(sizeof(struct port_data) <= CACHE_LINE_SIZE);
 
 /**************************************************************************//**
  * vlan_data struct that contains VLAN table information for a single VLAN.
+ * Entries come from 'vlan_pool', one cache line each.  Like ports, VLANs
+ * are keyed by row UUID.
  *****************************************************************************/
 struct vlan_data {
-    const struct ovsrec_vlan *idl_cfg;
+    struct hmap_node node;   /*!< In all_vlans, hashed on 'uuid'. */
+    struct uuid uuid;        /*!< UUID of the VLAN's row. */
+    const struct ovsrec_vlan *idl_cfg;  /*!< The VLAN's row, NULL once the
+                                             row is gone. */
 
-    char *name;              /*!< "name" column */
     int vid;                 /*!< "id" column */
     bool any_member_exists;  /*!< True if any PORT is a member of this VLAN. */
     enum ovsrec_vlan_admin_e admin;
     enum ovsrec_vlan_oper_state_e op_state;
     enum ovsrec_vlan_oper_state_reason_e op_state_reason;
 };
+BUILD_ASSERT_DECL(sizeof(struct vlan_data) <= CACHE_LINE_SIZE);
+
+/* Pools for port_data and vlan_data, and how many entries each slab holds. */
+#define PORT_POOL_SLAB_SIZE  64
+#define VLAN_POOL_SLAB_SIZE  256
+static struct vland_pool port_pool;
+static struct vland_pool vlan_pool;
 
 struct ovsdb_idl *idl;
 
@@ -82,14 +136,116 @@ static int system_configured = false;
 
 static int default_vlan_created  = false;
 
-/* Mapping of all the ports. */
-static struct shash all_ports = SHASH_INITIALIZER(&all_ports);
+/* All the ports, by row UUID. */
+static struct hmap all_ports = HMAP_INITIALIZER(&all_ports);
 
-/* Mapping of all the VLANs. */
-static struct shash all_vlans = SHASH_INITIALIZER(&all_vlans);
+/* All the VLANs, by row UUID. */
+static struct hmap all_vlans = HMAP_INITIALIZER(&all_vlans);
+
+/* The same VLANs indexed by VID, for vlan_lookup_by_vid().  Should two rows
+ * have the same VID, the slot holds one of them, as a search of 'all_vlans'
+ * would return. */
+static struct vlan_data *vlans_by_vid[VLAND_BITMAP_BITS];
 
 /* Bitmap of all VLANs defined in the system. */
-static unsigned long *all_vlans_bitmap;
+static struct vland_bitmap all_vlans_bitmap;
+
+/* Scratch bitmap of the VLANs affected by a port change. */
+static struct vland_bitmap modified_vlans_bitmap;
+
+/* Scratch bitmap in which a port's VLANs are built before they are stored in
+ * its compact 'vlans' set. */
+static struct vland_bitmap port_vlans_bitmap;
+
+/* Allocator for data that only lives for one vland_reconfigure() pass.
+ * It is reset at the end of every pass. */
+#define RUN_ARENA_BLOCK_SIZE  (64 * 1024)
+static struct vland_arena run_arena = VLAND_ARENA_INITIALIZER;
+
+/* UUIDs of the ports in bridges, rebuilt on each pass.  Nodes come from
+ * 'run_arena'.  See port_row_in_bridge(). */
+struct uuid_node {
+    struct hmap_node node;
+    struct uuid uuid;
+};
+static struct hmap bridge_ports = HMAP_INITIALIZER(&bridge_ports);
+
+/* Bitmap of VLANs whose cached status has not yet been acknowledged by
+ * OVSDB.  A VID stays dirty until a transaction carrying its status
+ * commits successfully, so failed or conflicting commits are retried
+ * together with any newer changes. */
+static struct vland_bitmap dirty_vlans_bitmap;
+
+/* Earliest time at which a failed status commit may be retried, and the
+ * backoff interval that produced it (0 after a successful commit). */
+static long long int txn_retry_time = LLONG_MIN;
+static int txn_backoff_msec = 0;
+
+/* True while this process holds the "ops_vland" lock and may write to
+ * OVSDB.  Without the lock vland runs as a standby: it keeps its caches up
+ * to date but writes nothing, and reconciles them against OVSDB as soon as
+ * it takes over.  See vland_reconcile(). */
+static bool vland_active = false;
+
+/* True while writes to OVSDB are allowed, i.e. this process is active and
+ * the system has been configured.  'reconcile_pending' is set each time
+ * writes become allowed. */
+static bool writes_enabled = false;
+static bool reconcile_pending = false;
+
+/* Time at which the system was seen to be configured, to report how long
+ * the first status commit took after that. */
+static long long int system_configured_msec = 0;
+static bool first_commit_logged = false;
+
+/* In-flight transaction creating the default VLAN, if any.  See
+ * default_vlan_run(). */
+static struct ovsdb_idl_txn *default_vlan_txn = NULL;
+
+/* True once the VLAN table monitor has been narrowed to non-internal VLANs.
+ * See vland_update_monitor_conditions(). */
+static bool vlan_monitor_filtered = false;
+
+/* A port whose row may have changed in this pass.  'row' is NULL if it
+ * did not. */
+struct port_change {
+    struct port_data *port;
+    const struct ovsrec_port *row;
+};
+
+/* Bulk handling of port changes; see resync_ports().  It is used when at
+ * least RESYNC_MIN_PORTS ports change in one pass. */
+#define RESYNC_MIN_PORTS  128
+static size_t n_resync_threads = 1;
+static struct vland_workers *resync_workers = NULL;
+static struct resync_worker_data *resync_wd = NULL;
+static long long int resync_usec = 0;
+static size_t resync_n_ports = 0;
+
+/* Pipelined mode; see pipeline_ingest().  'pipeline' is NULL in the default
+ * mode, in which the caches are updated on the main thread. */
+#define PIPELINE_RING_SIZE  65536
+static bool pipeline_enabled = false;
+static struct vland_pipeline *pipeline = NULL;
+
+/* Change records the pipeline had no room for, oldest first. */
+static struct vland_change **pipeline_backlog = NULL;
+static size_t n_pipeline_backlog = 0;
+static size_t allocated_pipeline_backlog = 0;
+static unsigned long long int pipeline_n_submitted = 0;
+
+/* A port known to the pipeline.  In pipelined mode the compute stage holds
+ * the port data, and 'all_ports' stays empty. */
+struct pipeline_port_node {
+    struct hmap_node node;      /* In 'pipeline_ports', hashed on 'uuid'. */
+    struct uuid uuid;
+    bool in_bridge;             /* As last submitted. */
+};
+static struct hmap pipeline_ports = HMAP_INITIALIZER(&pipeline_ports);
+
+/* Time spent in ovsdb_idl_run() parsing OVSDB updates. */
+static long long int idl_run_usec = 0;
+static unsigned long long int idl_run_count = 0;
 
 /* Forward Declarations */
 static char * vlan_mode_to_str(enum ovsrec_port_vlan_mode_e mode);
@@ -99,51 +255,126 @@ static char * vlan_oper_state_reason_to_str(enum ovsrec_vlan_oper_state_reason_e
 static struct vlan_data * vlan_lookup_by_vid(int vid);
 static void update_vlan_membership(struct vlan_data *vlan_ptr);
 static int handle_vlan_config(const struct ovsrec_vlan *row, struct vlan_data *vptr);
-bool check_port_in_bridge(const char *port_name);
 bool vland_default_vlan_member_port(void);
 
 /**********************************************************************/
 /*                               DEBUG                                */
 /**********************************************************************/
+static size_t
+idl_count_rows(const struct ovsdb_idl_table_class *tc)
+{
+    const struct ovsdb_idl_row *row;
+    size_t n = 0;
+
+    for (row = ovsdb_idl_first_row(idl, tc); row;
+         row = ovsdb_idl_next_row(row)) {
+        n++;
+    }
+    return n;
+
+} /* idl_count_rows */
+
 void
 vland_debug_dump(struct ds *ds)
 {
     int vid;
-    struct shash_node *sh_node;
+    struct port_data *port;
+    struct vlan_data *vl;
+    size_t n_vlan_sets[VLAN_SET_BITMAP + 1] = { 0 };
+    size_t vlan_set_bytes = 0;
 
     ds_put_cstr(ds, "================ Ports ================\n");
-    SHASH_FOR_EACH(sh_node, &all_ports) {
-        if(sh_node != NULL) {
-            int vid;
-            struct port_data *port = sh_node->data;
-            ds_put_format(ds, "Port %s:\n", port->name);
-            ds_put_format(ds, "  VLAN_mode=%s, native_VID=%d, trunk_all_VLANs=%s\n",
-                          vlan_mode_to_str(port->vlan_mode), port->native_vid,
-                          (port->trunk_all_vlans ? "true" : "false"));
-            ds_put_format(ds, "  VLANs:");
-            BITMAP_FOR_EACH_1(vid, VLAN_BITMAP_SIZE, port->vlans_bitmap) {
-                ds_put_format(ds, " %d,", vid);
-            }
-            ds_put_format(ds, "\n");
+    HMAP_FOR_EACH(port, node, &all_ports) {
+        const struct ovsrec_port *row
+            = ovsrec_port_get_for_uuid(idl, &port->uuid);
+        struct vlan_set_iter iter;
+
+        ds_put_format(ds, "Port %s:\n", row ? row->name : "");
+        ds_put_format(ds, "  VLAN_mode=%s, native_VID=%d, trunk_all_VLANs=%s\n",
+                      vlan_mode_to_str(port->vlan_mode), port->native_vid,
+                      (port->trunk_all_vlans ? "true" : "false"));
+        ds_put_format(ds, "  VLANs (%s):",
+                      vlan_set_type_name(&port->vlans));
+        VLAN_SET_FOR_EACH(vid, iter, &port->vlans) {
+            ds_put_format(ds, " %d,", vid);
         }
+        ds_put_format(ds, "\n");
     }
 
     ds_put_cstr(ds, "================ VLANs ================\n");
     ds_put_format(ds, "  All VLANs bitmap: ");
-    BITMAP_FOR_EACH_1(vid, VLAN_BITMAP_SIZE, all_vlans_bitmap) {
+    VLAND_BITMAP_FOR_EACH_1(vid, &all_vlans_bitmap) {
         ds_put_format(ds, " %d,", vid);
     }
     ds_put_format(ds, "\n");
 
-    SHASH_FOR_EACH(sh_node, &all_vlans) {
-        struct vlan_data *vl = sh_node->data;
+    HMAP_FOR_EACH(vl, node, &all_vlans) {
         ds_put_format(ds, "VLAN %d:\n", vl->vid);
-        ds_put_format(ds, "  name              :%s\n", vl->name);
+        ds_put_format(ds, "  name              :%s\n",
+                      vl->idl_cfg ? vl->idl_cfg->name : "");
         ds_put_format(ds, "  admin             :%s\n", vlan_admin_to_str(vl->admin));
         ds_put_format(ds, "  oper_state        :%s\n", vlan_oper_state_to_str(vl->op_state));
         ds_put_format(ds, "  oper_state_reason :%s\n", vlan_oper_state_reason_to_str(vl->op_state_reason));
     }
 
+    ds_put_cstr(ds, "============= Transactions ============\n");
+    ds_put_format(ds, "  Role              : %s\n",
+                  vland_active ? "active" : "standby");
+    ds_put_format(ds, "  Uncommitted VLANs: ");
+    VLAND_BITMAP_FOR_EACH_1(vid, &dirty_vlans_bitmap) {
+        ds_put_format(ds, " %d,", vid);
+    }
+    ds_put_format(ds, "\n");
+    if (txn_backoff_msec) {
+        ds_put_format(ds, "  Retry backoff     : %d ms\n", txn_backoff_msec);
+    }
+
+    ds_put_cstr(ds, "=========== IDL statistics ============\n");
+    ds_put_format(ds, "  Replicated rows   : %"PRIuSIZE" ports, %"PRIuSIZE" VLANs%s\n",
+                  idl_count_rows(&ovsrec_table_port),
+                  idl_count_rows(&ovsrec_table_vlan),
+                  vlan_monitor_filtered ? " (internal VLANs filtered)" : "");
+    ds_put_format(ds, "  Update processing : %lld us in %llu runs\n",
+                  idl_run_usec, idl_run_count);
+    ds_put_format(ds, "  Run arena         : %"PRIuSIZE" bytes high water\n",
+                  run_arena.high_water);
+    ds_put_format(ds, "  Last full resync  : %"PRIuSIZE" ports in %lld us, "
+                  "%"PRIuSIZE" threads\n", resync_n_ports, resync_usec,
+                  vland_workers_count(resync_workers));
+    if (pipeline) {
+        struct vland_pipeline_stats stats;
+
+        vland_pipeline_get_stats(pipeline, &stats);
+        ds_put_format(ds, "  Pipeline          : %llu records submitted, "
+                      "%"PRIuSIZE" waiting for room\n",
+                      pipeline_n_submitted, n_pipeline_backlog);
+        ds_put_format(ds, "                      %"PRIu64" applied in %"PRIu64
+                      " us, %"PRIu64" deltas in %"PRIu64" batches\n",
+                      stats.n_changes, stats.compute_usec, stats.n_deltas,
+                      stats.n_batches);
+    }
+
+    ds_put_cstr(ds, "============ Cache memory =============\n");
+    ds_put_format(ds, "  Bitmap operations : %s\n", vland_bitmap_impl_name());
+    ds_put_format(ds, "  Ports             : %"PRIuSIZE" in %"PRIuSIZE" bytes, "
+                  "%"PRIuSIZE" bytes/port\n",
+                  port_pool.n_used, vland_pool_bytes(&port_pool),
+                  port_pool.n_used
+                  ? vland_pool_bytes(&port_pool) / port_pool.n_used : 0);
+    HMAP_FOR_EACH(port, node, &all_ports) {
+        n_vlan_sets[port->vlans.type]++;
+        vlan_set_bytes += vlan_set_heap_bytes(&port->vlans);
+    }
+    ds_put_format(ds, "  Port VLAN sets    : %"PRIuSIZE" array, %"PRIuSIZE
+                  " ranges, %"PRIuSIZE" bitmap, %"PRIuSIZE" heap bytes\n",
+                  n_vlan_sets[VLAN_SET_ARRAY], n_vlan_sets[VLAN_SET_RANGES],
+                  n_vlan_sets[VLAN_SET_BITMAP], vlan_set_bytes);
+    ds_put_format(ds, "  VLANs             : %"PRIuSIZE" in %"PRIuSIZE" bytes, "
+                  "%"PRIuSIZE" bytes/VLAN\n",
+                  vlan_pool.n_used, vland_pool_bytes(&vlan_pool),
+                  vlan_pool.n_used
+                  ? vland_pool_bytes(&vlan_pool) / vlan_pool.n_used : 0);
+
 } /* vland_debug_dump */
 
 void
@@ -168,28 +399,104 @@ l2vlan_diag_dump_callback(const char *feature , char **buf)
 }
 
 /**********************************************************************/
-/*                              Ports                                 */
+/*                            Row lookup                              */
 /**********************************************************************/
 
-/**************************************************************************//**
- * This function parses a port's VLAN related configuration & constructs
- * a bitmap of all VLANs to which this port belongs.  Since all VLAN related
- * columns are optional in a PORT table entry, derive proper default values
- * for any missing data based on OVSDB schema definition.  Save the results
- * in the port_data structure for use later.
- *
- * @param[in] row - a table row entry in OVSDB's PORT table.
- * @param[out] port - port_data structure containing data for this port.
- *****************************************************************************/
+/* Returns the cached port for the row with 'uuid', or NULL. */
+static struct port_data *
+port_lookup(const struct uuid *uuid)
+{
+    struct port_data *port;
+
+    HMAP_FOR_EACH_WITH_HASH(port, node, uuid_hash(uuid), &all_ports) {
+        if (uuid_equals(&port->uuid, uuid)) {
+            return port;
+        }
+    }
+    return NULL;
+
+} /* port_lookup */
+
+/* Returns the cached VLAN for the row with 'uuid', or NULL. */
+static struct vlan_data *
+vlan_lookup(const struct uuid *uuid)
+{
+    struct vlan_data *vlan;
+
+    HMAP_FOR_EACH_WITH_HASH(vlan, node, uuid_hash(uuid), &all_vlans) {
+        if (uuid_equals(&vlan->uuid, uuid)) {
+            return vlan;
+        }
+    }
+    return NULL;
+
+} /* vlan_lookup */
+
+/* Adds 'uuid' to 'set', a set of uuid_nodes allocated from 'run_arena'. */
 static void
-construct_vlan_bitmap(const struct ovsrec_port *row, struct port_data *port)
+uuid_set_add_arena(struct hmap *set, const struct uuid *uuid)
+{
+    struct uuid_node *n = vland_arena_alloc(&run_arena, sizeof *n);
+
+    n->uuid = *uuid;
+    hmap_insert(set, &n->node, uuid_hash(uuid));
+
+} /* uuid_set_add_arena */
+
+/* Returns the node for 'uuid' in 'set', or NULL. */
+static struct uuid_node *
+uuid_set_find(const struct hmap *set, const struct uuid *uuid)
+{
+    struct uuid_node *n;
+
+    HMAP_FOR_EACH_WITH_HASH(n, node, uuid_hash(uuid), set) {
+        if (uuid_equals(&n->uuid, uuid)) {
+            return n;
+        }
+    }
+    return NULL;
+
+} /* uuid_set_find */
+
+/* Rebuilds 'bridge_ports' from the bridges' "ports" columns, so that
+ * port_row_in_bridge() need not search every bridge for every port. */
+static void
+index_bridge_ports(void)
+{
+    const struct ovsrec_system *system = ovsrec_system_first(idl);
+    size_t i, j;
+
+    hmap_clear(&bridge_ports);
+    for (i = 0; system && i < system->n_bridges; i++) {
+        const struct ovsrec_bridge *br = system->bridges[i];
+
+        for (j = 0; j < br->n_ports; j++) {
+            uuid_set_add_arena(&bridge_ports, &br->ports[j]->header_.uuid);
+        }
+    }
+
+} /* index_bridge_ports */
+
+/* Returns true if Port 'row' is in a bridge.  Only valid after
+ * index_bridge_ports() in the same pass. */
+static bool
+port_row_in_bridge(const struct ovsrec_port *row)
+{
+    return uuid_set_find(&bridge_ports, &row->header_.uuid) != NULL;
+
+} /* port_row_in_bridge */
+
+/**********************************************************************/
+/*                              Ports                                 */
+/**********************************************************************/
+
+/* Returns the VLAN mode of Port 'row', applying the schema defaults if the
+ * "vlan_mode" column is not set. */
+static enum ovsrec_port_vlan_mode_e
+port_row_vlan_mode(const struct ovsrec_port *row)
 {
-    int native_vid = -1;
-    bool trunk_all_vlans = false;
-    unsigned long *vbmp = NULL;
     enum ovsrec_port_vlan_mode_e vlan_mode;
 
-    /* Get vlan_mode first. */
     if (row->vlan_mode) {
         if (strcmp(row->vlan_mode, OVSREC_PORT_VLAN_MODE_ACCESS) == 0) {
             vlan_mode = PORT_VLAN_MODE_ACCESS;
@@ -215,231 +522,526 @@ construct_vlan_bitmap(const struct ovsrec_port *row, struct port_data *port)
         }
     }
 
+    return vlan_mode;
+
+} /* port_row_vlan_mode */
+
+/* Returns the native VID of Port 'row' in 'vlan_mode', or -1 if none. */
+static int
+port_row_native_vid(const struct ovsrec_port *row,
+                    enum ovsrec_port_vlan_mode_e vlan_mode)
+{
     /* Get native VID from 'tag' column.  Ignore if TRUNK mode. */
     if ((row->vlan_tag != NULL) && (vlan_mode != PORT_VLAN_MODE_TRUNK)) {
-        native_vid = (int)ops_port_get_tag(row);
+        return (int)ops_port_get_tag(row);
+    }
+
+    return -1;
+
+} /* port_row_native_vid */
+
+/* Returns true if the "tag" column of Port 'row', or if it has no tag its
+ * "trunks" column, holds the default VLAN. */
+static bool
+port_row_has_default_vlan(const struct ovsrec_port *row)
+{
+    size_t i;
+
+    if (row->vlan_tag != NULL) {
+        return ops_port_get_tag(row) == DEFAULT_VID;
     }
 
-    /* Get VLAN membership next. */
+    for (i = 0; i < row->n_vlan_trunks; i++) {
+        if (ops_port_get_trunks(row, i) == DEFAULT_VID) {
+            return true;
+        }
+    }
+    return false;
+
+} /* port_row_has_default_vlan */
+
+/**************************************************************************//**
+ * This function parses a port's VLAN related configuration & constructs
+ * a bitmap of all VLANs to which this port belongs.  Since all VLAN related
+ * columns are optional in a PORT table entry, derive proper default values
+ * for any missing data based on OVSDB schema definition.  Save the results
+ * in the port_data structure for use later.
+ *
+ * The port's VLANs are built in 'vbmp', which is left holding them.
+ *
+ * @param[in] row - a table row entry in OVSDB's PORT table.
+ * @param[out] port - port_data structure containing data for this port.
+ * @param[out] vbmp - scratch bitmap.
+ *****************************************************************************/
+static void
+construct_vlan_bitmap(const struct ovsrec_port *row, struct port_data *port,
+                      struct vland_bitmap *vbmp)
+{
+    int native_vid;
+    bool trunk_all_vlans = false;
+    bool native_in_trunks = false;
+    bool in_bridge;
+    size_t n_trunks = 0;
+    enum ovsrec_port_vlan_mode_e vlan_mode;
+
+    /* Get vlan_mode first. */
+    vlan_mode = port_row_vlan_mode(row);
+
+    native_vid = port_row_native_vid(row, vlan_mode);
+    in_bridge = port_row_in_bridge(row);
+
+    /* Get VLAN membership next.  Build it in the scratch bitmap, then store
+     * it in the port's compact set. */
     if ((row->n_vlan_trunks > 0) && (vlan_mode != PORT_VLAN_MODE_ACCESS)) {
         /* 'trunks' column is not empty, and VLAN mode is one of
          * the TRUNK modes.  Construct bitmap of VLANs from 'trunks'
-         * column.  This API will allocate the bitmap. */
+         * column. */
         int index;
-        int64_t *vlan_trunks = xmalloc(sizeof(int64_t) * (row->n_vlan_trunks));
+
+        vland_bitmap_zero(vbmp);
         for (index = 0; index < row->n_vlan_trunks; index++) {
-            vlan_trunks[index] = ops_port_get_trunks(row, index);
+            int64_t vid = ops_port_get_trunks(row, index);
+
+            if (vid >= 0 && vid < VLAND_BITMAP_BITS) {
+                vland_bitmap_set1(vbmp, vid);
+            }
+            if (vid == native_vid) {
+                native_in_trunks = true;
+            }
         }
-        vbmp = vlan_bitmap_from_array(vlan_trunks, row->n_vlan_trunks);
-        free(vlan_trunks);
+        n_trunks = row->n_vlan_trunks;
 
     } else if (vlan_mode == PORT_VLAN_MODE_ACCESS) {
-        /* Port is ACCESS mode.  Ignore 'trunks' column & allocate
-         * an empty bitmap. */
-        vbmp = bitmap_allocate(VLAN_BITMAP_SIZE);
+        /* Port is ACCESS mode.  Ignore 'trunks' column & clear
+         * the bitmap. */
+        vland_bitmap_zero(vbmp);
 
     } else {
         /* 'trunks' column is empty & VLAN mode is one of the
          * TRUNK modes (trunk, native-tagged, or native-untagged).
          * This means all VLANs defined in VLAN table will be
          * configured on this port.*/
-        vbmp = vlan_bitmap_clone(all_vlans_bitmap);
-        if (check_port_in_bridge(row->name))
+        vland_bitmap_copy(vbmp, &all_vlans_bitmap);
+        if (in_bridge)
            trunk_all_vlans = true;
     }
 
     /* Finally, add in native VLAN into VLAN bitmap. */
     if (VALID_VID(native_vid)) {
-        bitmap_set(vbmp, native_vid, true);
+        vland_bitmap_set1(vbmp, native_vid);
     }
 
     /* Done. Save new VLAN info. */
+    vlan_set_from_bitmap(&port->vlans, vbmp);
     port->vlan_mode = vlan_mode;
     port->native_vid = native_vid;
-    port->vlans_bitmap = vbmp;
     port->trunk_all_vlans = trunk_all_vlans;
+    port->in_bridge = in_bridge;
+    port->n_trunks = n_trunks;
+    port->native_in_trunks = native_in_trunks;
 
 } /* construct_vlan_bitmap */
 
+/**************************************************************************//**
+ * This function checks whether the VLAN related columns of a port row still
+ * match the inputs its cached "vlans" set was built from.  After a
+ * reconnect to OVSDB the IDL reloads every row, and all of them look
+ * inserted; this lets unchanged ports skip construct_vlan_bitmap() and the
+ * VLAN updates that follow it.
+ *
+ * The trunks are compared without building a bitmap: the cached set holds
+ * the old trunks plus the native VLAN.  With the same mode, native VID,
+ * number of trunks and native-in-trunks flag, every new trunk being in that
+ * set means the two sets of trunks are equal.
+ *
+ * @param[in] row - a table row entry in OVSDB's PORT table.
+ * @param[in] port - port_data structure last built for this port.
+ *
+ * @return true if the port's VLAN membership cannot have changed.
+ *****************************************************************************/
+static bool
+port_vlan_inputs_unchanged(const struct ovsrec_port *row,
+                           const struct port_data *port)
+{
+    enum ovsrec_port_vlan_mode_e vlan_mode = port_row_vlan_mode(row);
+    int native_vid = port_row_native_vid(row, vlan_mode);
+    bool native_in_trunks = false;
+    size_t n_trunks;
+    size_t i;
+
+    n_trunks = (vlan_mode == PORT_VLAN_MODE_ACCESS ? 0 : row->n_vlan_trunks);
+    if (vlan_mode != port->vlan_mode ||
+        native_vid != port->native_vid ||
+        n_trunks != port->n_trunks ||
+        port_row_in_bridge(row) != port->in_bridge) {
+        return false;
+    }
+
+    for (i = 0; i < n_trunks; i++) {
+        int64_t vid = ops_port_get_trunks(row, i);
+
+        if (!vlan_set_contains(&port->vlans, vid)) {
+            return false;
+        }
+        if (vid == native_vid) {
+            native_in_trunks = true;
+        }
+    }
+
+    return native_in_trunks == port->native_in_trunks;
+
+} /* port_vlan_inputs_unchanged */
+
 static int
-del_old_port(struct shash_node *sh_node)
+del_old_port(struct port_data *port)
 {
+    struct vlan_set_iter iter;
     int vid;
     int rc = 0;
 
-    if (sh_node) {
-        struct port_data *port = sh_node->data;
-
-        /* Remove this port from the list of all_ports first.
-         * This is needed to correctly update VLAN membership. */
-        shash_delete(&all_ports, sh_node);
-
-        /* Go through each VLAN that this port is a member of,
-         * and update its configuration as necessary. */
-        BITMAP_FOR_EACH_1(vid, VLAN_BITMAP_SIZE, port->vlans_bitmap) {
-            struct vlan_data *vlan = vlan_lookup_by_vid(vid);
-            if (vlan) {
-                update_vlan_membership(vlan);
-                if (handle_vlan_config(vlan->idl_cfg, vlan)) {
-                    rc++;
-                }
+    /* Remove this port from the list of all_ports first.
+     * This is needed to correctly update VLAN membership. */
+    hmap_remove(&all_ports, &port->node);
+
+    /* Go through each VLAN that this port is a member of,
+     * and update its configuration as necessary. */
+    VLAN_SET_FOR_EACH(vid, iter, &port->vlans) {
+        struct vlan_data *vlan = vlan_lookup_by_vid(vid);
+        if (vlan) {
+            update_vlan_membership(vlan);
+            if (handle_vlan_config(vlan->idl_cfg, vlan)) {
+                rc++;
             }
         }
-
-        // Done.  Free the rest of the structure.
-        free(port->name);
-        bitmap_free(port->vlans_bitmap);
-        free(port);
     }
 
+    // Done.  Free the rest of the structure.
+    vlan_set_destroy(&port->vlans);
+    vland_pool_free(&port_pool, port);
+
     return rc;
 
 } /* del_old_port */
 
-static void
+static struct port_data *
 add_new_port(const struct ovsrec_port *port_row)
 {
-    struct port_data *new_port = NULL;
+    struct port_data *new_port;
 
     /* Allocate structure to save state information for this port. */
-    new_port = xzalloc(sizeof(struct port_data));
+    new_port = vland_pool_alloc(&port_pool);
+    new_port->uuid = port_row->header_.uuid;
+    hmap_insert(&all_ports, &new_port->node, uuid_hash(&new_port->uuid));
 
-    if (!shash_add_once(&all_ports, port_row->name, new_port)) {
-        VLOG_WARN("Port %s specified twice", port_row->name);
-        free(new_port);
-    } else {
-        new_port->name = xstrdup(port_row->name);
+    /* No VLANs for now. */
+    vlan_set_init(&new_port->vlans);
+    new_port->native_vid = -1;
+    new_port->trunk_all_vlans = false;
+    new_port->vlan_mode = PORT_VLAN_MODE_ACCESS;
+    new_port->in_bridge = false;
+    new_port->n_trunks = 0;
+    new_port->native_in_trunks = false;
 
-        /* Initialize VLANs to NULL for now. */
-        new_port->native_vid = -1;
-        new_port->vlans_bitmap = bitmap_allocate(VLAN_BITMAP_SIZE);
-        new_port->trunk_all_vlans = false;
-        new_port->vlan_mode = PORT_VLAN_MODE_ACCESS;
+    VLOG_DBG("Created local data for Port %s", port_row->name);
 
-        VLOG_DBG("Created local data for Port %s", port_row->name);
-    }
+    return new_port;
 
 } /* add_new_port */
 
-bool
-check_port_in_bridge(const char *port_name)
+/**************************************************************************//**
+ * Full resync.
+ *
+ * The serial path above revisits every VLAN of every changed port, and
+ * update_vlan_membership() scans all ports for each of those VLANs.  When
+ * most ports change at once, as on a cold start or after a reconnect, that
+ * is quadratic.  Instead, resync_ports() works in two parallel phases while
+ * the main thread holds off IDL processing, so the IDL rows stay read-only:
+ *
+ *   1. Ports are partitioned among the workers.  Each worker rebuilds the
+ *      VLANs of its changed ports, and collects the VLANs whose membership
+ *      may have changed and the VLANs that have an in-bridge member.
+ *
+ *   2. The merged VLANs to update are partitioned by VID range.  Each
+ *      worker sets the membership of its VLANs from the merged member
+ *      bitmap and recomputes their state.  Ranges are whole bitmap words so
+ *      that workers never write the same word of 'dirty_vlans_bitmap'.
+ *****************************************************************************/
+struct resync_worker_data {
+    struct vland_bitmap old_vlans;    /* Scratch: a port's previous VLANs. */
+    struct vland_bitmap new_vlans;    /* Scratch: a port's new VLANs. */
+    struct vland_bitmap modified;     /* VLANs to update. */
+    struct vland_bitmap members;      /* VLANs with a member in a bridge. */
+    size_t n_recomputed;
+    size_t n_unchanged;
+    int rc;
+};
+
+struct resync_job {
+    struct port_change *changes;
+    size_t n_changes;
+    struct resync_worker_data *wd;    /* One per worker. */
+    struct vland_bitmap modified;     /* Merged from all workers. */
+    struct vland_bitmap members;      /* Merged from all workers. */
+};
+
+static void
+resync_ports_work(void *job_, size_t idx, size_t n)
 {
-    const struct ovsrec_system *ovs_row = NULL;
-    struct ovsrec_bridge *br_cfg = NULL;
-    struct ovsrec_port *port_cfg = NULL;
-    size_t i, j;
-    ovs_row = ovsrec_system_first(idl);
-    if (ovs_row == NULL) {
-        return false;
+    struct resync_job *job = job_;
+    struct resync_worker_data *wd = &job->wd[idx];
+    size_t start, end, i;
+
+    vland_bitmap_zero(&wd->modified);
+    vland_bitmap_zero(&wd->members);
+    wd->n_recomputed = 0;
+    wd->n_unchanged = 0;
+
+    vland_workers_split(job->n_changes, 1, idx, n, &start, &end);
+    for (i = start; i < end; i++) {
+        const struct ovsrec_port *row = job->changes[i].row;
+        struct port_data *port = job->changes[i].port;
+
+        if (row && port_vlan_inputs_unchanged(row, port)) {
+            wd->n_unchanged++;
+        } else if (row) {
+            bool was_in_bridge = port->in_bridge;
+
+            wd->n_recomputed++;
+            vland_bitmap_zero(&wd->old_vlans);
+            vlan_set_or_into_bitmap(&port->vlans, &wd->old_vlans);
+            construct_vlan_bitmap(row, port, &wd->new_vlans);
+
+            if (port->in_bridge != was_in_bridge) {
+                vland_bitmap_or(&wd->modified, &wd->old_vlans);
+                vland_bitmap_or(&wd->modified, &wd->new_vlans);
+            } else if (vland_bitmap_xor(&wd->old_vlans, &wd->old_vlans,
+                                        &wd->new_vlans)) {
+                vland_bitmap_or(&wd->modified, &wd->old_vlans);
+            }
+        }
+
+        /* A port trunking all VLANs already holds every cached VLAN, so
+         * its set alone gives its memberships. */
+        if (port->in_bridge) {
+            vlan_set_or_into_bitmap(&port->vlans, &wd->members);
+        }
     }
-    for (i = 0; i < ovs_row->n_bridges; i++) {
-        br_cfg = ovs_row->bridges[i];
-        for (j = 0; j < br_cfg->n_ports; j++) {
-            port_cfg = br_cfg->ports[j];
-            if (strcmp(port_name, port_cfg->name) == 0) {
-                return true;
+
+} /* resync_ports_work */
+
+static void
+resync_vlans_work(void *job_, size_t idx, size_t n)
+{
+    struct resync_job *job = job_;
+    struct resync_worker_data *wd = &job->wd[idx];
+    size_t start, end;
+    int vid;
+
+    wd->rc = 0;
+
+    vland_workers_split(VLAND_BITMAP_BITS, VLAND_BITMAP_ULONG_BITS, idx, n,
+                        &start, &end);
+    for (vid = vland_bitmap_scan(&job->modified, true, start); vid < end;
+         vid = vland_bitmap_scan(&job->modified, true, vid + 1)) {
+        struct vlan_data *vlan = vlan_lookup_by_vid(vid);
+
+        if (vlan) {
+            vlan->any_member_exists = vland_bitmap_is_set(&job->members, vid);
+            if (handle_vlan_config(vlan->idl_cfg, vlan)) {
+                wd->rc++;
             }
         }
     }
-    return false;
-}
 
+} /* resync_vlans_work */
+
+static int
+resync_ports(struct port_change *changes, size_t n_changes)
+{
+    size_t n_workers = vland_workers_count(resync_workers);
+    long long int start = time_usec();
+    struct resync_job job;
+    size_t n_recomputed = 0, n_unchanged = 0;
+    size_t i;
+    int rc = 0;
+
+    COVERAGE_INC(vland_resync);
+
+    job.changes = changes;
+    job.n_changes = n_changes;
+    job.wd = resync_wd;
+
+    /* Phase 1: ports. */
+    vland_workers_run(resync_workers, resync_ports_work, &job);
+
+    vland_bitmap_zero(&job.modified);
+    vland_bitmap_zero(&job.members);
+    for (i = 0; i < n_workers; i++) {
+        vland_bitmap_or(&job.modified, &resync_wd[i].modified);
+        vland_bitmap_or(&job.members, &resync_wd[i].members);
+        n_recomputed += resync_wd[i].n_recomputed;
+        n_unchanged += resync_wd[i].n_unchanged;
+    }
+    COVERAGE_ADD(vland_port_recompute, n_recomputed);
+    COVERAGE_ADD(vland_port_unchanged, n_unchanged);
+
+    /* Phase 2: VLANs. */
+    vland_workers_run(resync_workers, resync_vlans_work, &job);
+    for (i = 0; i < n_workers; i++) {
+        rc += resync_wd[i].rc;
+    }
+
+    resync_usec = time_usec() - start;
+    resync_n_ports = n_changes;
+    VLOG_INFO("Resynchronized %"PRIuSIZE" ports (%"PRIuSIZE" rebuilt) and "
+              "%"PRIuSIZE" VLANs on %"PRIuSIZE" threads in %lld us",
+              n_changes, n_recomputed, vland_bitmap_count(&job.modified),
+              n_workers, resync_usec);
+
+    return rc;
+
+} /* resync_ports */
 
 static int
 update_port_cache(void)
 {
-    struct shash sh_idl_ports;
     const struct ovsrec_port *row;
-    struct shash_node *sh_node, *sh_next;
-    const struct ovsrec_vlan *vlanrow;
+    struct port_data *port, *next;
+    struct port_change *changes;
+    size_t n_changes = 0, n_changed = 0;
+    size_t n_cached, n_found = 0;
+    bool bridges_changed;
+    size_t i;
     int rc = 0;
 
-    /* Collect all the ports in the DB. */
-    shash_init(&sh_idl_ports);
+    /* Port membership depends on the port being in a bridge.  Caches may be
+     * built before the bridges are fully set up, so when the set of bridges
+     * or their ports changes, recheck the ports that joined or left a
+     * bridge. */
+    bridges_changed = (OVSREC_IDL_IS_COLUMN_MODIFIED(ovsrec_system_col_bridges,
+                                                     idl_seqno) ||
+                       OVSREC_IDL_IS_COLUMN_MODIFIED(ovsrec_bridge_col_ports,
+                                                     idl_seqno));
+
+    /* Collect all the ports in the DB, each with its cached data if it has
+     * any. */
+    changes = vland_arena_alloc(&run_arena, idl_count_rows(&ovsrec_table_port)
+                                            * sizeof *changes);
+    n_cached = hmap_count(&all_ports);
     OVSREC_PORT_FOR_EACH(row, idl) {
-        if (!shash_add_once(&sh_idl_ports, row->name, row)) {
-            VLOG_WARN("port %s specified twice", row->name);
+        struct port_change *change;
+
+        /* note: "bridge_normal" is not really a port, ignore it */
+        if (!strcmp(row->name, DEFAULT_BRIDGE_NAME)) {
+            continue;
+        }
+
+        change = &changes[n_changes++];
+        change->port = port_lookup(&row->header_.uuid);
+        change->row = row;
+        if (change->port) {
+            n_found++;
         }
     }
 
-    /* Delete old ports. */
-    SHASH_FOR_EACH_SAFE(sh_node, sh_next, &all_ports) {
-        struct port_data *port = shash_find_data(&sh_idl_ports, sh_node->name);
-        if (!port) {
-            VLOG_DBG("Found a deleted port %s", sh_node->name);
-            if (del_old_port(sh_node)) {
-                rc++;
+    /* Delete old ports.  Only needed if some cached port has no row. */
+    if (n_found < n_cached) {
+        HMAP_FOR_EACH_SAFE(port, next, node, &all_ports) {
+            row = ovsrec_port_get_for_uuid(idl, &port->uuid);
+            if (!row || !strcmp(row->name, DEFAULT_BRIDGE_NAME)) {
+                VLOG_DBG("Found a deleted port "UUID_FMT,
+                         UUID_ARGS(&port->uuid));
+                if (del_old_port(port)) {
+                    rc++;
+                }
             }
         }
     }
 
-    /* Add new ports. */
-    SHASH_FOR_EACH(sh_node, &sh_idl_ports) {
-        if (sh_node != NULL) {
-            struct port_data *new_port = shash_find_data(&all_ports, sh_node->name);
-            /* note: "bridge_normal" is not really a port, ignore it */
-            if (!new_port && strcmp(sh_node->name, DEFAULT_BRIDGE_NAME) != 0) {
-                VLOG_DBG("Found an added port %s", sh_node->name);
-                add_new_port(sh_node->data);
-            }
+    /* Add new ports, and find the port rows that changed. */
+    for (i = 0; i < n_changes; i++) {
+        struct port_change *change = &changes[i];
+
+        if (!change->port) {
+            VLOG_DBG("Found an added port %s", change->row->name);
+            change->port = add_new_port(change->row);
+        }
+        if (OVSREC_IDL_IS_ROW_INSERTED(change->row, idl_seqno) ||
+            OVSREC_IDL_IS_ROW_MODIFIED(change->row, idl_seqno) ||
+            (bridges_changed &&
+             port_row_in_bridge(change->row) != change->port->in_bridge)) {
+            n_changed++;
+        } else {
+            change->row = NULL;
         }
     }
 
+    /* A cold start or reconnect changes most ports at once.  Handle those
+     * in bulk, on all resync threads. */
+    if (n_changed >= RESYNC_MIN_PORTS) {
+        rc += resync_ports(changes, n_changes);
+        n_changes = 0;
+    }
+
     /* Check for changes in the port row entries. */
-    SHASH_FOR_EACH(sh_node, &all_ports) {
-        if (sh_node != NULL) {
-
-            const struct ovsrec_port *row = shash_find_data(&sh_idl_ports,
-                                                        sh_node->name);
-            /* Check for changes to row. */
-            if (OVSREC_IDL_IS_ROW_INSERTED(row, idl_seqno) ||
-                OVSREC_IDL_IS_ROW_MODIFIED(row, idl_seqno)) {
-                struct port_data *port = sh_node->data;
-                unsigned long *modified_vlans;
-                int vid;
-
-                VLOG_DBG("Received updates for port %s", row->name);
-
-                /* Save old VLAN bitmap first.  If this is a new port,
-                * go ahead and allocate a blank bitmap for use later. */
-                modified_vlans = port->vlans_bitmap;
-
-                /* Update bitmap of VLANs to which this PORT belongs. */
-                construct_vlan_bitmap(row, port);
-
-                /* Combine both new & old VLANs since we need to update
-                 * all of their status. */
-                bitmap_or(modified_vlans, port->vlans_bitmap, VLAN_BITMAP_SIZE);
-                BITMAP_FOR_EACH_1(vid, VLAN_BITMAP_SIZE, modified_vlans) {
-                    OVSREC_VLAN_FOR_EACH(vlanrow, idl) {
-                        if(vlanrow->id == vid) {
-                            struct vlan_data *vlan = vlan_lookup_by_vid(vid);
-                            if (vlan)  {
-                                update_vlan_membership(vlan);
-                                if (smap_get(&vlanrow->internal_usage,
-                                    VLAN_INTERNAL_USAGE_L3PORT)) {
-                                    VLOG_DBG("%s is used internally for L3 interface."
-                                             "Skip config", vlanrow->name);
-                                    continue;
-                                }
-                                if (handle_vlan_config(vlan->idl_cfg, vlan)) {
-                                    rc++;
-                                }
-                            }
-                        }
-                    }
-                }
+    for (i = 0; i < n_changes; i++) {
+        const struct ovsrec_port *row = changes[i].row;
+        struct port_data *port = changes[i].port;
+        struct vland_bitmap *modified_vlans = &modified_vlans_bitmap;
+        bool was_in_bridge = port->in_bridge;
+        int vid;
+
+        if (!row) {
+            continue;
+        }
+
+        VLOG_DBG("Received updates for port %s", row->name);
+
+        if (port_vlan_inputs_unchanged(row, port)) {
+            COVERAGE_INC(vland_port_unchanged);
+            continue;
+        }
+        COVERAGE_INC(vland_port_recompute);
+
+        /* Save old VLANs first. */
+        vland_bitmap_zero(modified_vlans);
+        vlan_set_or_into_bitmap(&port->vlans, modified_vlans);
 
-                /* Done. */
-                bitmap_free(modified_vlans);
+        /* Update bitmap of VLANs to which this PORT belongs. */
+        construct_vlan_bitmap(row, port, &port_vlans_bitmap);
+
+        if (port->in_bridge == was_in_bridge) {
+            /* Only VLANs the port joined or left can change. */
+            if (!vland_bitmap_xor(modified_vlans, modified_vlans,
+                                  &port_vlans_bitmap)) {
+                continue;
             }
+        } else {
+            /* Joining or leaving a bridge affects every VLAN of the
+             * port, so update both new & old VLANs. */
+            vland_bitmap_or(modified_vlans, &port_vlans_bitmap);
         }
-    }
+        VLAND_BITMAP_FOR_EACH_1(vid, modified_vlans) {
+            struct vlan_data *vlan = vlan_lookup_by_vid(vid);
 
-        /* Destroy the shash of the IDL ports */
-        shash_destroy(&sh_idl_ports);
+            /* VLANs deleted from OVSDB are left to update_vlan_cache(). */
+            if (!vlan || !vlan->idl_cfg) {
+                continue;
+            }
+            update_vlan_membership(vlan);
+            if (smap_get(&vlan->idl_cfg->internal_usage,
+                         VLAN_INTERNAL_USAGE_L3PORT)) {
+                VLOG_DBG("%s is used internally for L3 interface."
+                         "Skip config", vlan->idl_cfg->name);
+                continue;
+            }
+            if (handle_vlan_config(vlan->idl_cfg, vlan)) {
+                rc++;
+            }
+        }
+    }
 
-        return rc;
+    return rc;
 
 } /* update_port_cache */
 
@@ -537,17 +1139,7 @@ vlan_oper_state_reason_to_str(enum ovsrec_vlan_oper_state_reason_e reason)
 static struct vlan_data *
 vlan_lookup_by_vid(int vid)
 {
-    struct shash_node *sh_node;
-
-    SHASH_FOR_EACH(sh_node, &all_vlans) {
-        if(sh_node != NULL) {
-            struct vlan_data *vlan = sh_node->data;
-            if (vlan->vid == vid) {
-                return vlan;
-            }
-        }
-    }
-    return NULL;
+    return vid >= 0 && vid < VLAND_BITMAP_BITS ? vlans_by_vid[vid] : NULL;
 
 } /* vlan_lookup_by_vid */
 
@@ -556,7 +1148,6 @@ parse_vlan_data(const struct ovsrec_vlan *data, struct vlan_data *vlan_ptr)
 {
     /* Save a pointer to the IDL data for use later. */
     vlan_ptr->idl_cfg = data;
-    vlan_ptr->name = xstrdup(data->name);
     vlan_ptr->vid = data->id;
     vlan_ptr->any_member_exists = false;
     vlan_ptr->admin = VLAN_ADMIN_DOWN;
@@ -572,7 +1163,7 @@ parse_vlan_data(const struct ovsrec_vlan *data, struct vlan_data *vlan_ptr)
  * through all ports configured in the system that references this VLAN,
  * whether explicitly via "tag" or "trunks" column, or implicitly via
  * trunking all VLANs defined in the VLAN table.  Also adds this VLAN to
- * a port's "vlans_bitmap" if it is implicitly trunking all VLANs.
+ * a port's "vlans" set if it is implicitly trunking all VLANs.
  *
  * @param[in] vlan_ptr - vlan_data structure containing data for this VLAN.
  *****************************************************************************/
@@ -580,25 +1171,22 @@ static void
 update_vlan_membership(struct vlan_data *vlan_ptr)
 {
     bool found = false;
-    struct shash_node *sh_node;
     struct port_data *port;
 
-    SHASH_FOR_EACH(sh_node, &all_ports) {
-        if(sh_node != NULL){
-            port = sh_node->data;
-            if (!check_port_in_bridge(port->name))
-               continue;
-
-            /* Add this new VLAN to any port that's implicitly trunking all VLANs. */
-            if (port->trunk_all_vlans) {
-                found = true;
-                bitmap_set(port->vlans_bitmap, vlan_ptr->vid, true);
-
-            } else if (bitmap_is_set(port->vlans_bitmap, vlan_ptr->vid)) {
-                found = true;
-                /* Do not exit here.  We need to update all other
-                 * ports that may be implicitly trunking all VLANs. */
-            }
+    HMAP_FOR_EACH(port, node, &all_ports) {
+        if (!port->in_bridge) {
+            continue;
+        }
+
+        /* Add this new VLAN to any port that's implicitly trunking all VLANs. */
+        if (port->trunk_all_vlans) {
+            found = true;
+            vlan_set_add(&port->vlans, vlan_ptr->vid);
+
+        } else if (vlan_set_contains(&port->vlans, vlan_ptr->vid)) {
+            found = true;
+            /* Do not exit here.  We need to update all other
+             * ports that may be implicitly trunking all VLANs. */
         }
     }
     vlan_ptr->any_member_exists = found;
@@ -644,32 +1232,13 @@ calc_vlan_op_state_n_reason(struct vlan_data *new_vlan,
     enum ovsrec_vlan_oper_state_e state;
     enum ovsrec_vlan_oper_state_reason_e reason;
 
-    /* Default to operationally disabled. */
-    state  = VLAN_OPER_STATE_DOWN;
-    reason = VLAN_OPER_STATE_REASON_UNKNOWN;
-
-   /* Default VLAN oper_state is always up */
-    if (new_vlan->vid == DEFAULT_VID) {
-        state  = VLAN_OPER_STATE_UP;
-        /* Default VLAN oper_state_reason is ok if it is a part of any port */
-        if (vland_default_vlan_member_port()) {
-            new_vlan->any_member_exists = true;
-        }
+    /* Default VLAN oper_state_reason is ok if it is a part of any port */
+    if (new_vlan->vid == DEFAULT_VID && vland_default_vlan_member_port()) {
+        new_vlan->any_member_exists = true;
     }
 
-   /* Check for admin state first. */
-    if (new_vlan->admin == VLAN_ADMIN_DOWN) {
-        reason = VLAN_OPER_STATE_REASON_ADMIN_DOWN;
-
-    /* Check if any port is configured for this VLAN. */
-    } else if (!new_vlan->any_member_exists) {
-        reason = VLAN_OPER_STATE_REASON_NO_MEMBER_PORT;
-
-    /* If we get here, everything's fine. */
-    } else {
-        state  = VLAN_OPER_STATE_UP;
-        reason = VLAN_OPER_STATE_REASON_OK;
-    }
+    vland_oper_state_calc(new_vlan->vid, new_vlan->admin != VLAN_ADMIN_DOWN,
+                          new_vlan->any_member_exists, &state, &reason);
 
     VLOG_DBG("new_state=%s, new_reason=%s",
              vlan_oper_state_to_str(state),
@@ -682,11 +1251,10 @@ calc_vlan_op_state_n_reason(struct vlan_data *new_vlan,
 } /* calc_vlan_op_state_n_reason */
 
 /**************************************************************************//**
- * This function handles a VLAN's updated configuration.  First, calculate
- * the VLAN's new "oper_state" and "oper_state_reason".  If there's any
- * change, update "hw_vlan_config" column accordingly in order to drive
- * the VLAN configuration into h/w.  Finally, update VLAN status columns
- * in the OVSDB.
+ * This function handles a VLAN's updated configuration.  Calculate the
+ * VLAN's new "oper_state" and "oper_state_reason".  If there's any change,
+ * save the new state and mark the VLAN dirty so that its "hw_vlan_config"
+ * and status columns are written by the next status commit.
  *
  * @param[in] row - a table row entry in OVSDB's VLAN table.
  * @param[out] vptr - vlan_data structure containing data for this VLAN.
@@ -694,12 +1262,16 @@ calc_vlan_op_state_n_reason(struct vlan_data *new_vlan,
 static int
 handle_vlan_config(const struct ovsrec_vlan *row, struct vlan_data *vptr)
 {
-    struct smap hw_cfg_smap;
     enum ovsrec_vlan_oper_state_e new_state;
     enum ovsrec_vlan_oper_state_reason_e new_reason;
 
+    if (!row) {
+        /* The VLAN's row is gone; update_vlan_cache() will delete it. */
+        return 0;
+    }
+
     VLOG_DBG("%s entry: name=%s, vid=%d, op_state=%s, op_state_reason=%s",
-             __FUNCTION__, vptr->name, vptr->vid,
+             __FUNCTION__, row->name, vptr->vid,
              vlan_oper_state_to_str(vptr->op_state),
              vlan_oper_state_reason_to_str(vptr->op_state_reason));
 
@@ -709,8 +1281,7 @@ handle_vlan_config(const struct ovsrec_vlan *row, struct vlan_data *vptr)
         return 0;
     }
 
-    /* Update VLAN's op state & reason, and update h/w
-     * config & status elements as appropriate. */
+    /* Update VLAN's op state & reason. */
     calc_vlan_op_state_n_reason(vptr, &new_state, &new_reason);
 
     if ((new_state == vptr->op_state) &&
@@ -722,152 +1293,474 @@ handle_vlan_config(const struct ovsrec_vlan *row, struct vlan_data *vptr)
     vptr->op_state = new_state;
     vptr->op_state_reason = new_reason;
 
-    if (VLAN_OPER_STATE_UP == vptr->op_state) {
-        /* State is up.  Update hw_vlan_config to push
-         * VLAN configuration info into h/w. */
-        smap_init(&hw_cfg_smap);
-        smap_add(&hw_cfg_smap, "enable", VLAN_HW_CONFIG_MAP_ENABLE_TRUE);
-        ovsrec_vlan_set_hw_vlan_config(row, &hw_cfg_smap);
-
-    } else {
-        /* State is down.  Delete hw_vlan_config. */
-        smap_init(&hw_cfg_smap);
-        ovsrec_vlan_set_hw_vlan_config(row, &hw_cfg_smap);
-    }
-
-    /* Update VLAN status. */
-    ovsrec_vlan_set_oper_state(row, vlan_oper_state_to_str(vptr->op_state));
-    ovsrec_vlan_set_oper_state_reason(row, vlan_oper_state_reason_to_str(vptr->op_state_reason));
+    /* Keep the VLAN dirty until its new status is committed. */
+    vland_bitmap_set1(&dirty_vlans_bitmap, vptr->vid);
 
     /* Return non-zero to indicate need to update row data in OVSDB. */
     return 1;
 
 } /* handle_vlan_config */
 
-static void
-add_new_vlan(struct shash_node *sh_node)
+/**************************************************************************//**
+ * This function writes a VLAN's cached state into the current transaction.
+ * If the VLAN is operationally up, set the "enable" key of "hw_vlan_config"
+ * to push the VLAN configuration into h/w; otherwise remove that key.  Only
+ * the "enable" key is touched, so other keys in the column are preserved,
+ * and nothing is sent when the key already has the desired value.  Then
+ * update the VLAN status columns.
+ *
+ * @param[in] vptr - vlan_data structure containing data for this VLAN.
+ *****************************************************************************/
+static void
+write_vlan_status(const struct vlan_data *vptr)
 {
-    struct vlan_data *new_vlan = NULL;
-    const struct ovsrec_vlan *vlan_row = sh_node->data;
+    const struct ovsrec_vlan *row = vptr->idl_cfg;
+    const char *hw_enable = smap_get(&row->hw_vlan_config, "enable");
 
-    /* Allocate structure to save state information for this VLAN. */
-    new_vlan = xzalloc(sizeof(struct vlan_data));
+    if (VLAN_OPER_STATE_UP == vptr->op_state) {
+        /* State is up.  Update hw_vlan_config to push
+         * VLAN configuration info into h/w. */
+        if (!hw_enable || strcmp(hw_enable, VLAN_HW_CONFIG_MAP_ENABLE_TRUE)) {
+            ovsrec_vlan_update_hw_vlan_config_setkey(
+                row, "enable", VLAN_HW_CONFIG_MAP_ENABLE_TRUE);
+        }
 
-    if (!shash_add_once(&all_vlans, vlan_row->name, new_vlan)) {
-        VLOG_WARN("VLAN %d specified twice", (int)vlan_row->id);
-        free(new_vlan);
-    } else {
-        /* Parse OVSDB data into internal format. */
-        parse_vlan_data(vlan_row, new_vlan);
+    } else if (hw_enable) {
+        /* State is down.  Remove the VLAN from h/w. */
+        ovsrec_vlan_update_hw_vlan_config_delkey(row, "enable");
+    }
 
-        /* Save VLAN in global bitmap. */
-        bitmap_set(all_vlans_bitmap, new_vlan->vid, true);
+    /* Update VLAN status. */
+    ovsrec_vlan_set_oper_state(row, vlan_oper_state_to_str(vptr->op_state));
+    ovsrec_vlan_set_oper_state_reason(row, vlan_oper_state_reason_to_str(vptr->op_state_reason));
 
-        /* Check if any member port exists for this VLAN. */
-        update_vlan_membership(new_vlan);
+} /* write_vlan_status */
+
+static struct vlan_data *
+add_new_vlan(const struct ovsrec_vlan *vlan_row)
+{
+    struct vlan_data *new_vlan;
 
-        VLOG_DBG("Created local data for VLAN %d", (int)vlan_row->id);
+    /* Allocate structure to save state information for this VLAN. */
+    new_vlan = vland_pool_alloc(&vlan_pool);
+    new_vlan->uuid = vlan_row->header_.uuid;
+    hmap_insert(&all_vlans, &new_vlan->node, uuid_hash(&new_vlan->uuid));
+
+    /* Parse OVSDB data into internal format. */
+    parse_vlan_data(vlan_row, new_vlan);
+
+    /* Save VLAN in global bitmap and VID index. */
+    vland_bitmap_set1(&all_vlans_bitmap, new_vlan->vid);
+    if (new_vlan->vid >= 0 && new_vlan->vid < VLAND_BITMAP_BITS
+        && !vlans_by_vid[new_vlan->vid]) {
+        vlans_by_vid[new_vlan->vid] = new_vlan;
     }
+
+    /* Check if any member port exists for this VLAN. */
+    update_vlan_membership(new_vlan);
+
+    VLOG_DBG("Created local data for VLAN %d", (int)vlan_row->id);
+
+    return new_vlan;
+
 } /* add_new_vlan */
 
 static void
-del_old_vlan(struct shash_node *sh_node)
+del_old_vlan(struct vlan_data *vl)
 {
-    if (sh_node) {
-        struct vlan_data *vl = sh_node->data;
-        struct port_data *port;
-        struct shash_node *port_node;
-
-        /* Remove this VLAN from any port that's implicitly trunking all VLANs. */
-        SHASH_FOR_EACH(port_node, &all_ports) {
-            if(port_node != NULL){
-                port = port_node->data;
-                if (port->trunk_all_vlans) {
-                    bitmap_set(port->vlans_bitmap, vl->vid, false);
-                }
+    struct port_data *port;
+
+    /* Remove this VLAN from any port that's implicitly trunking all VLANs. */
+    HMAP_FOR_EACH(port, node, &all_ports) {
+        if (port->trunk_all_vlans) {
+            vlan_set_remove(&port->vlans, vl->vid);
+        }
+    }
+    vland_bitmap_set0(&all_vlans_bitmap, vl->vid);
+    vland_bitmap_set0(&dirty_vlans_bitmap, vl->vid);
+    hmap_remove(&all_vlans, &vl->node);
+
+    /* Hand the VID over to any other VLAN that has it. */
+    if (vlan_lookup_by_vid(vl->vid) == vl) {
+        struct vlan_data *other;
+
+        vlans_by_vid[vl->vid] = NULL;
+        HMAP_FOR_EACH(other, node, &all_vlans) {
+            if (other->vid == vl->vid) {
+                vlans_by_vid[vl->vid] = other;
+                break;
             }
         }
-        bitmap_set(all_vlans_bitmap, vl->vid, false);
-        free(vl->name);
-        free(vl);
-        shash_delete(&all_vlans, sh_node);
     }
+    vland_pool_free(&vlan_pool, vl);
 
 } /* del_old_vlan */
 
 static int
 update_vlan_cache(void)
 {
-    struct vlan_data *new_vlan;
-    struct shash sh_idl_vlans;
+    struct vlan_data *vptr, *next;
     const struct ovsrec_vlan *row;
-    struct shash_node *sh_node, *sh_next;
     int rc = 0;
 
-    /* Collect all the VLANs in the DB. */
-    shash_init(&sh_idl_vlans);
+    /* Delete old VLANs.  rebind_vlan_rows() left them without a row. */
+    HMAP_FOR_EACH_SAFE(vptr, next, node, &all_vlans) {
+        if (!vptr->idl_cfg) {
+            VLOG_DBG("Found a deleted VLAN %d", vptr->vid);
+            del_old_vlan(vptr);
+        }
+    }
+
     OVSREC_VLAN_FOR_EACH(row, idl) {
-        if (!shash_add_once(&sh_idl_vlans, row->name, row)) {
-            VLOG_WARN("VLAN %s (%d) specified twice", row->name, (int)row->id);
+        enum ovsrec_vlan_admin_e admin;
+
+        /* Add new VLANs. */
+        vptr = vlan_lookup(&row->header_.uuid);
+        if (!vptr) {
+            VLOG_DBG("Found an added VLAN %s", row->name);
+            vptr = add_new_vlan(row);
+        } else if (vptr->vid != row->id) {
+            /* A VLAN's ID does not normally change.  If it does, start
+             * over as for a new VLAN. */
+            del_old_vlan(vptr);
+            vptr = add_new_vlan(row);
+        }
+
+        /* Check for changes to row. */
+        if (!OVSREC_IDL_IS_ROW_INSERTED(row, idl_seqno) &&
+            !OVSREC_IDL_IS_ROW_MODIFIED(row, idl_seqno)) {
+            continue;
+        }
+
+        /* The only thing that should change is optional 'admin' column. */
+        admin = VLAN_ADMIN_DOWN;
+        if (row->admin &&
+            strcmp(OVSREC_VLAN_ADMIN_UP, row->admin) == 0) {
+            admin = VLAN_ADMIN_UP;
+        }
+
+        /* Skip rows that were only reloaded.  A VLAN whose state has
+         * never been computed still needs it. */
+        if (admin == vptr->admin &&
+            vptr->op_state != VLAN_OPER_STATE_UNKNOWN) {
+            COVERAGE_INC(vland_vlan_unchanged);
+            continue;
+        }
+        vptr->admin = admin;
+
+        /* Handle VLAN config update. */
+        if (handle_vlan_config(row, vptr)) {
+            rc++;
         }
     }
 
-    /* Delete old VLANs. */
-    SHASH_FOR_EACH_SAFE(sh_node, sh_next, &all_vlans) {
-        if(sh_node != NULL){
-            new_vlan = shash_find_data(&sh_idl_vlans, sh_node->name);
-            if (!new_vlan) {
-                VLOG_DBG("Found a deleted VLAN %s", sh_node->name);
-                del_old_vlan(sh_node);
-            }
+    return rc;
+
+} /* update_vlan_cache */
+
+/**********************************************************************/
+/*                          Pipelined mode                            */
+/**********************************************************************/
+
+/* Hands 'change' to the compute stage, or keeps it until there is room.
+ * Records never overtake the ones kept before them. */
+static void
+pipeline_submit(struct vland_change *change)
+{
+    COVERAGE_INC(vland_pipeline_change);
+    pipeline_n_submitted++;
+
+    if (n_pipeline_backlog || !vland_pipeline_submit(pipeline, change)) {
+        COVERAGE_INC(vland_pipeline_backlog);
+        if (n_pipeline_backlog >= allocated_pipeline_backlog) {
+            pipeline_backlog = x2nrealloc(pipeline_backlog,
+                                          &allocated_pipeline_backlog,
+                                          sizeof *pipeline_backlog);
+        }
+        pipeline_backlog[n_pipeline_backlog++] = change;
+    }
+
+} /* pipeline_submit */
+
+/* Submits as many kept records as the compute stage has room for. */
+static void
+pipeline_submit_backlog(void)
+{
+    size_t i;
+
+    for (i = 0; i < n_pipeline_backlog; i++) {
+        if (!vland_pipeline_submit(pipeline, pipeline_backlog[i])) {
+            break;
         }
     }
-    /* Add new VLANs. */
-    SHASH_FOR_EACH(sh_node, &sh_idl_vlans) {
-        new_vlan = shash_find_data(&all_vlans, sh_node->name);
-        if (!new_vlan) {
-            VLOG_DBG("Found an added VLAN %s", sh_node->name);
-            add_new_vlan(sh_node);
+    if (i) {
+        n_pipeline_backlog -= i;
+        memmove(pipeline_backlog, &pipeline_backlog[i],
+                n_pipeline_backlog * sizeof *pipeline_backlog);
+        vland_pipeline_flush(pipeline);
+    }
+
+} /* pipeline_submit_backlog */
+
+/* Returns the node for 'uuid' in 'pipeline_ports', or NULL. */
+static struct pipeline_port_node *
+pipeline_port_find(const struct uuid *uuid)
+{
+    struct pipeline_port_node *n;
+
+    HMAP_FOR_EACH_WITH_HASH(n, node, uuid_hash(uuid), &pipeline_ports) {
+        if (uuid_equals(&n->uuid, uuid)) {
+            return n;
         }
     }
+    return NULL;
 
-    /* Check for changes in the VLAN row entries. */
-    SHASH_FOR_EACH(sh_node, &all_vlans) {
-        const struct ovsrec_vlan *row = shash_find_data(&sh_idl_vlans,
-                                                        sh_node->name);
-        /* Check for changes to row. */
-        if (OVSREC_IDL_IS_ROW_INSERTED(row, idl_seqno) ||
-            OVSREC_IDL_IS_ROW_MODIFIED(row, idl_seqno)) {
+} /* pipeline_port_find */
 
-            struct vlan_data *vptr = sh_node->data;
+/* Returns a change record with the VLAN inputs of Port 'row'.  This is the
+ * record form of construct_vlan_bitmap(). */
+static struct vland_change *
+pipeline_port_change(const struct ovsrec_port *row, bool in_bridge)
+{
+    enum ovsrec_port_vlan_mode_e vlan_mode = port_row_vlan_mode(row);
+    size_t n_trunks = (vlan_mode == PORT_VLAN_MODE_ACCESS
+                       ? 0 : row->n_vlan_trunks);
+    struct vland_change *change;
+    size_t i;
+
+    change = vland_change_create(VLAND_CHANGE_PORT, n_trunks);
+    change->uuid = row->header_.uuid;
+    change->in_bridge = in_bridge;
+    change->trunk_all = (vlan_mode != PORT_VLAN_MODE_ACCESS
+                         && row->n_vlan_trunks == 0);
+    change->default_member = port_row_has_default_vlan(row);
+    change->native_vid = port_row_native_vid(row, vlan_mode);
+    for (i = 0; i < n_trunks; i++) {
+        int64_t vid = ops_port_get_trunks(row, i);
+
+        /* Out of range VIDs are passed on as UINT16_MAX, which the compute
+         * stage ignores. */
+        change->trunks[i] = (vid >= 0 && vid < VLAND_BITMAP_BITS
+                             ? vid : UINT16_MAX);
+    }
 
-            /* The only thing that should change is optional 'admin' column. */
-            vptr->admin = VLAN_ADMIN_DOWN;
-            if (row->admin &&
-                strcmp(OVSREC_VLAN_ADMIN_UP, row->admin) == 0) {
-                vptr->admin = VLAN_ADMIN_UP;
-            }
+    return change;
 
-            /* Handle VLAN config update. */
-            if (handle_vlan_config(row, vptr)) {
-                rc++;
+} /* pipeline_port_change */
+
+/**************************************************************************//**
+ * This function is the ingest stage of the pipelined mode, which replaces
+ * update_port_cache() and update_vlan_cache().  It turns the Port and VLAN
+ * rows that changed into change records for the compute stage (see
+ * vland_pipeline.h) and returns without waiting for their result.
+ *
+ * The VLAN cache is still kept here, since status commits write through its
+ * rows; the compute stage reports new VLAN states back to it, see
+ * pipeline_collect().  The port cache lives in the compute stage only.
+ *****************************************************************************/
+static void
+pipeline_ingest(void)
+{
+    const struct ovsrec_port *port_row;
+    const struct ovsrec_vlan *vlan_row;
+    struct vlan_data *vptr, *vnext;
+    struct pipeline_port_node *n, *next;
+    struct vland_change *change;
+    size_t n_known, n_found = 0;
+    bool bridges_changed;
+
+    bridges_changed = (OVSREC_IDL_IS_COLUMN_MODIFIED(ovsrec_system_col_bridges,
+                                                     idl_seqno) ||
+                       OVSREC_IDL_IS_COLUMN_MODIFIED(ovsrec_bridge_col_ports,
+                                                     idl_seqno));
+
+    /* VLANs.  rebind_vlan_rows() left the deleted ones without a row. */
+    HMAP_FOR_EACH_SAFE(vptr, vnext, node, &all_vlans) {
+        if (!vptr->idl_cfg) {
+            change = vland_change_create(VLAND_CHANGE_VLAN_DEL, 0);
+            change->uuid = vptr->uuid;
+            change->vid = vptr->vid;
+            pipeline_submit(change);
+            del_old_vlan(vptr);
+        }
+    }
+
+    OVSREC_VLAN_FOR_EACH(vlan_row, idl) {
+        vptr = vlan_lookup(&vlan_row->header_.uuid);
+        if (!vptr) {
+            vptr = add_new_vlan(vlan_row);
+        } else if (vptr->vid != vlan_row->id) {
+            change = vland_change_create(VLAND_CHANGE_VLAN_DEL, 0);
+            change->uuid = vptr->uuid;
+            change->vid = vptr->vid;
+            pipeline_submit(change);
+            del_old_vlan(vptr);
+            vptr = add_new_vlan(vlan_row);
+        }
+
+        if (OVSREC_IDL_IS_ROW_INSERTED(vlan_row, idl_seqno) ||
+            OVSREC_IDL_IS_ROW_MODIFIED(vlan_row, idl_seqno)) {
+            vptr->admin = (vlan_row->admin
+                           && !strcmp(vlan_row->admin, OVSREC_VLAN_ADMIN_UP)
+                           ? VLAN_ADMIN_UP : VLAN_ADMIN_DOWN);
+
+            change = vland_change_create(VLAND_CHANGE_VLAN, 0);
+            change->uuid = vptr->uuid;
+            change->vid = vptr->vid;
+            change->admin_up = vptr->admin == VLAN_ADMIN_UP;
+            change->internal = smap_get(&vlan_row->internal_usage,
+                                        VLAN_INTERNAL_USAGE_L3PORT) != NULL;
+            pipeline_submit(change);
+        }
+    }
+
+    /* Ports. */
+    n_known = hmap_count(&pipeline_ports);
+    OVSREC_PORT_FOR_EACH(port_row, idl) {
+        bool in_bridge;
+
+        /* note: "bridge_normal" is not really a port, ignore it */
+        if (!strcmp(port_row->name, DEFAULT_BRIDGE_NAME)) {
+            continue;
+        }
+
+        n = pipeline_port_find(&port_row->header_.uuid);
+        if (n) {
+            n_found++;
+        }
+
+        /* A change to "Bridge:ports" only affects the ports it added or
+         * removed. */
+        if (n && !OVSREC_IDL_IS_ROW_INSERTED(port_row, idl_seqno) &&
+            !OVSREC_IDL_IS_ROW_MODIFIED(port_row, idl_seqno) &&
+            (!bridges_changed ||
+             port_row_in_bridge(port_row) == n->in_bridge)) {
+            continue;
+        }
+
+        if (!n) {
+            n = xmalloc(sizeof *n);
+            n->uuid = port_row->header_.uuid;
+            hmap_insert(&pipeline_ports, &n->node, uuid_hash(&n->uuid));
+        }
+        in_bridge = port_row_in_bridge(port_row);
+        n->in_bridge = in_bridge;
+        pipeline_submit(pipeline_port_change(port_row, in_bridge));
+    }
+
+    /* Deleted ports.  Only needed if some known port has no row. */
+    if (n_found < n_known) {
+        HMAP_FOR_EACH_SAFE(n, next, node, &pipeline_ports) {
+            port_row = ovsrec_port_get_for_uuid(idl, &n->uuid);
+            if (!port_row || !strcmp(port_row->name, DEFAULT_BRIDGE_NAME)) {
+                change = vland_change_create(VLAND_CHANGE_PORT_DEL, 0);
+                change->uuid = n->uuid;
+                pipeline_submit(change);
+                hmap_remove(&pipeline_ports, &n->node);
+                free(n);
             }
         }
     }
 
-    /* Destroy the shash of the IDL vlans */
-    shash_destroy(&sh_idl_vlans);
+    vland_pipeline_flush(pipeline);
 
-    return rc;
+} /* pipeline_ingest */
 
-} /* update_vlan_cache */
+/**************************************************************************//**
+ * This function applies the VLAN states computed by the compute stage to
+ * the VLAN cache and marks the VLANs that changed dirty.  All batches ready
+ * are applied at once, so that they go out in a single status commit.  It
+ * then submits any change records that were waiting for room.
+ *
+ * States are matched to VLANs by row UUID, not by VID.  A state computed
+ * before its VLAN was deleted, or before the row's "id" changed, has no
+ * entry to go to and is dropped; the VID is then owned by no row or by a
+ * row the compute stage reports separately once it has seen the change.
+ *****************************************************************************/
+static void
+pipeline_collect(void)
+{
+    struct vland_delta_batch *batch;
+    struct vlan_data *vptr;
+    size_t i;
+
+    while ((batch = vland_pipeline_next_deltas(pipeline)) != NULL) {
+        for (i = 0; i < batch->n; i++) {
+            const struct vland_state_delta *delta = &batch->deltas[i];
+
+            vptr = vlan_lookup(&delta->uuid);
+            if (!vptr || vptr->vid != delta->vid) {
+                COVERAGE_INC(vland_pipeline_stale_delta);
+                VLOG_DBG("Dropping state of VLAN %d, row "UUID_FMT" was "
+                         "deleted or renumbered", delta->vid,
+                         UUID_ARGS(&delta->uuid));
+                continue;
+            }
+            vptr->any_member_exists = delta->any_member;
+            vptr->op_state = delta->state;
+            vptr->op_state_reason = delta->reason;
+            vland_bitmap_set1(&dirty_vlans_bitmap, delta->vid);
+        }
+        free(batch);
+    }
+
+    pipeline_submit_backlog();
+
+} /* pipeline_collect */
 
 /**********************************************************************/
 /*                              OVSDB                                 */
 /**********************************************************************/
 
+/**************************************************************************//**
+ * This function sets the OVSDB monitor condition on the VLAN table so that
+ * vland replicates only the VLAN rows it can act on.
+ *
+ * The Port table is not conditioned.  A port in a bridge with none of
+ * "vlan_mode", "tag" or "trunks" set implicitly trunks every VLAN, and
+ * whether a port is in a bridge is only known from "Bridge:ports", which a
+ * condition on the Port table cannot express.
+ *
+ * VLAN rows used internally by L3 interfaces are skipped by vland, but the
+ * whole VLAN table is replicated until the default VLAN exists, because
+ * creating it rewrites "Bridge:vlans" and unreplicated rows would drop out
+ * of that column.  After that the monitor is narrowed to non-internal VLANs.
+ *****************************************************************************/
+static void
+vland_update_monitor_conditions(void)
+{
+    if (default_vlan_created && !vlan_monitor_filtered) {
+        struct ovsdb_idl_condition vlan_cond
+            = OVSDB_IDL_CONDITION_INIT(&vlan_cond);
+        struct smap no_usage = SMAP_INITIALIZER(&no_usage);
+
+        ovsrec_vlan_add_clause_internal_usage(&vlan_cond, OVSDB_F_EQ,
+                                              &no_usage);
+        ovsrec_vlan_set_condition(idl, &vlan_cond);
+        ovsdb_idl_condition_destroy(&vlan_cond);
+        vlan_monitor_filtered = true;
+
+        VLOG_DBG("Monitoring non-internal VLANs only");
+    }
+
+} /* vland_update_monitor_conditions */
+
 /* Create a connection to the OVSDB at db_path and create a DB cache
  * for this daemon. */
+void
+vland_ovsdb_set_resync_threads(size_t n_threads)
+{
+    n_resync_threads = MAX(n_threads, 1);
+
+} /* vland_ovsdb_set_resync_threads */
+
+void
+vland_ovsdb_set_pipeline(bool enable)
+{
+    pipeline_enabled = enable;
+
+} /* vland_ovsdb_set_pipeline */
+
 void
 vland_ovsdb_init(const char *db_path)
 {
@@ -878,9 +1771,14 @@ vland_ovsdb_init(const char *db_path)
 
     /* Cache System table. */
     ovsdb_idl_add_table(idl, &ovsrec_table_system);
-    ovsdb_idl_add_column(idl, &ovsrec_system_col_cur_cfg);
     ovsdb_idl_add_column(idl, &ovsrec_system_col_bridges);
 
+    /* "cur_cfg" is checked on every vland_run() until the system is
+     * configured, and never after that, so changes to it need not wake us
+     * up.  Alerts can only be omitted before the IDL receives any data. */
+    ovsdb_idl_add_column(idl, &ovsrec_system_col_cur_cfg);
+    ovsdb_idl_omit_alert(idl, &ovsrec_system_col_cur_cfg);
+
     /* Cache Port and VLAN tables and columns. */
     ovsdb_idl_add_table(idl, &ovsrec_table_port);
     ovsdb_idl_add_column(idl, &ovsrec_port_col_name);
@@ -891,9 +1789,13 @@ vland_ovsdb_init(const char *db_path)
     ovsdb_idl_add_table(idl, &ovsrec_table_vlan);
     ovsdb_idl_add_column(idl, &ovsrec_vlan_col_internal_usage);
     ovsdb_idl_add_column(idl, &ovsrec_vlan_col_admin);
-    ovsdb_idl_add_column(idl, &ovsrec_vlan_col_name);
     ovsdb_idl_add_column(idl, &ovsrec_vlan_col_id);
 
+    /* VLAN name is only read when a VLAN is first seen.  A rename on its
+     * own does not affect VLAN state, so it need not wake us up. */
+    ovsdb_idl_add_column(idl, &ovsrec_vlan_col_name);
+    ovsdb_idl_omit_alert(idl, &ovsrec_vlan_col_name);
+
     /* These VLAN columns are write-only for VLAND. */
     ovsdb_idl_add_column(idl, &ovsrec_vlan_col_hw_vlan_config);
     ovsdb_idl_omit_alert(idl, &ovsrec_vlan_col_hw_vlan_config);
@@ -904,108 +1806,226 @@ vland_ovsdb_init(const char *db_path)
     ovsdb_idl_add_column(idl, &ovsrec_vlan_col_oper_state_reason);
     ovsdb_idl_omit_alert(idl, &ovsrec_vlan_col_oper_state_reason);
 
-    /* Initialize global VLANs bitmap. */
-    all_vlans_bitmap = bitmap_allocate(VLAN_BITMAP_SIZE);
+    /* Pick the VLAN bitmap kernels for this CPU. */
+    VLOG_INFO("Using %s VLAN bitmap operations", vland_bitmap_init());
+
+    vland_pool_init(&port_pool, sizeof(struct port_data), PORT_POOL_SLAB_SIZE);
+    vland_pool_init(&vlan_pool, sizeof(struct vlan_data), VLAN_POOL_SLAB_SIZE);
+
+    vland_arena_init(&run_arena, RUN_ARENA_BLOCK_SIZE);
 
-    /* These BRIDGE columns are write-only for VLAND. */
+    resync_workers = vland_workers_create(n_resync_threads);
+    resync_wd = xmalloc_cacheline(vland_workers_count(resync_workers)
+                                  * sizeof *resync_wd);
+
+    if (pipeline_enabled) {
+        pipeline = vland_pipeline_create(PIPELINE_RING_SIZE);
+    }
+
+    /* These BRIDGE columns are write-only for VLAND.  "name" is only
+     * used to find the default bridge, so it does not need alerts. */
     ovsdb_idl_add_table(idl, &ovsrec_table_bridge);
 
     ovsdb_idl_add_column(idl, &ovsrec_bridge_col_name);
+    ovsdb_idl_omit_alert(idl, &ovsrec_bridge_col_name);
 
     ovsdb_idl_add_column(idl, &ovsrec_bridge_col_ports);
 
     ovsdb_idl_add_column(idl, &ovsrec_bridge_col_vlans);
     ovsdb_idl_omit_alert(idl, &ovsrec_bridge_col_vlans);
 
+    /* Only replicate the VLAN rows vland can act on. */
+    vland_update_monitor_conditions();
+
 } /* vland_ovsdb_init */
 
 void
 vland_ovsdb_exit(void)
 {
-    shash_destroy_free_data(&all_ports);
-    shash_destroy_free_data(&all_vlans);
+    struct port_data *port;
+    struct pipeline_port_node *n, *next;
+    size_t i;
+
+    HMAP_FOR_EACH(port, node, &all_ports) {
+        vlan_set_destroy(&port->vlans);
+    }
+    hmap_destroy(&all_ports);
+    hmap_destroy(&all_vlans);
+    vland_pool_destroy(&port_pool);
+    vland_pool_destroy(&vlan_pool);
+    hmap_destroy(&bridge_ports);
+    vland_arena_destroy(&run_arena);
+    vland_workers_destroy(resync_workers);
+    free_cacheline(resync_wd);
+    vland_pipeline_destroy(pipeline);
+    pipeline = NULL;
+    for (i = 0; i < n_pipeline_backlog; i++) {
+        free(pipeline_backlog[i]);
+    }
+    free(pipeline_backlog);
+    HMAP_FOR_EACH_SAFE(n, next, node, &pipeline_ports) {
+        hmap_remove(&pipeline_ports, &n->node);
+        free(n);
+    }
+    hmap_destroy(&pipeline_ports);
+    if (default_vlan_txn) {
+        ovsdb_idl_txn_destroy(default_vlan_txn);
+        default_vlan_txn = NULL;
+    }
     ovsdb_idl_destroy(idl);
 
 } /* vland_ovsdb_exit */
 
-static int
-create_default_vlan()
+/* Returns true if the default VLAN is already in the VLAN table. */
+static bool
+default_vlan_exists(void)
 {
-    const struct ovsrec_vlan *vlan_row = NULL;
-    const struct ovsrec_bridge *bridge_row = NULL;
-    const struct ovsrec_bridge *default_bridge_row = NULL;
-    struct ovsdb_idl_txn *status_txn;
-    enum ovsdb_idl_txn_status status;
-    bool vlan_found = false;
-    struct ovsrec_vlan **vlans = NULL;
-    int i = 0;
-    int vlan_id = DEFAULT_VID ;
-    static char vlan_name[32] = { 0 };
-
-    snprintf(vlan_name, sizeof(vlan_name), "%s%d", "DEFAULT_VLAN_", vlan_id);
-    status_txn = ovsdb_idl_txn_create(idl);
+    const struct ovsrec_vlan *vlan_row;
 
-    vlan_row = ovsrec_vlan_first(idl);
-    if (vlan_row != NULL) {
-        OVSREC_VLAN_FOR_EACH(vlan_row, idl) {
-            if (vlan_row->id == vlan_id) {
-                vlan_found = true;
-                VLOG_DBG("%s already created. skipping", vlan_name);
-                ovsdb_idl_txn_destroy(status_txn);
-                default_vlan_created = true;
-                return false;
-            }
+    OVSREC_VLAN_FOR_EACH(vlan_row, idl) {
+        if (vlan_row->id == DEFAULT_VID) {
+            return true;
         }
     }
 
-    if (!vlan_found) {
-        vlan_row = ovsrec_vlan_insert(status_txn);
-        ovsrec_vlan_set_id(vlan_row, vlan_id);
-        ovsrec_vlan_set_name(vlan_row, vlan_name);
-        ovsrec_vlan_set_admin(vlan_row, OVSREC_VLAN_ADMIN_UP);
-        ovsrec_vlan_set_oper_state(vlan_row, OVSREC_VLAN_OPER_STATE_DOWN);
-        ovsrec_vlan_set_oper_state_reason(vlan_row, OVSREC_VLAN_OPER_STATE_REASON_ADMIN_DOWN);
-
-        OVSREC_BRIDGE_FOR_EACH(bridge_row, idl) {
-            if (strcmp(bridge_row->name, DEFAULT_BRIDGE_NAME) == 0) {
-                default_bridge_row = (struct ovsrec_bridge*)bridge_row;
-                break;
-            }
-        }
+    return false;
 
-        if (default_bridge_row == NULL) {
-            VLOG_ERR("Couldn't find default bridge, failed to create %s. Function=%s, Line=%d",
-                      vlan_name, __func__, __LINE__);
-            ovsdb_idl_txn_destroy(status_txn);
-            return false;
-        }
+} /* default_vlan_exists */
 
-        vlans = xmalloc(sizeof(*default_bridge_row->vlans) *
-            (default_bridge_row->n_vlans + 1));
+static const struct ovsrec_bridge *
+find_default_bridge(void)
+{
+    const struct ovsrec_bridge *bridge_row;
 
-        for (i = 0; i < default_bridge_row->n_vlans; i++) {
-            vlans[i] = default_bridge_row->vlans[i];
+    OVSREC_BRIDGE_FOR_EACH(bridge_row, idl) {
+        if (strcmp(bridge_row->name, DEFAULT_BRIDGE_NAME) == 0) {
+            return bridge_row;
         }
+    }
 
-        vlans[default_bridge_row->n_vlans] = CONST_CAST(struct ovsrec_vlan*,vlan_row);
-        ovsrec_bridge_set_vlans(default_bridge_row, vlans,
-            default_bridge_row->n_vlans + 1);
+    return NULL;
 
-        free(vlans);
-    }
+} /* find_default_bridge */
 
-    status = ovsdb_idl_txn_commit_block(status_txn);
-    if(status != TXN_SUCCESS && status != TXN_UNCHANGED) {
-        VLOG_ERR("Creating default VLAN failed, status = %s\n",
+/* Handles the final 'status' of the default VLAN transaction. */
+static void
+default_vlan_txn_done(enum ovsdb_idl_txn_status status)
+{
+    if (status != TXN_SUCCESS && status != TXN_UNCHANGED) {
+        VLOG_ERR("Creating default VLAN failed, status = %s",
                  ovsdb_idl_txn_status_to_string(status));
     } else {
         VLOG_DBG("Creating default VLAN, success");
         default_vlan_created = true;
     }
 
-    ovsdb_idl_txn_destroy(status_txn);
-    return true;
-}
+    ovsdb_idl_txn_destroy(default_vlan_txn);
+    default_vlan_txn = NULL;
+
+} /* default_vlan_txn_done */
+
+/**************************************************************************//**
+ * This function drives creation of the default VLAN without blocking the
+ * main loop.  It is called on every pass until the default VLAN exists:
+ *
+ *   - if the VLAN already exists, e.g. created by an earlier run, done.
+ *   - else once writes are allowed and the default bridge is present,
+ *     insert the VLAN, add it to Bridge:vlans and submit the transaction.
+ *   - while the transaction is in flight, poll it; vland_wait() wakes us
+ *     up when it completes.  A failed transaction is resubmitted on a
+ *     later pass.
+ *
+ * Port and VLAN processing carry on meanwhile; only the VLAN status commit
+ * waits, since the IDL allows one transaction at a time.
+ *****************************************************************************/
+static void
+default_vlan_run(void)
+{
+    static bool bridge_missing_logged = false;
+    const struct ovsrec_bridge *default_bridge_row;
+    const struct ovsrec_vlan *vlan_row;
+    struct ovsrec_vlan **vlans;
+    enum ovsdb_idl_txn_status status;
+    char vlan_name[32];
+    size_t i;
+
+    if (default_vlan_txn) {
+        status = ovsdb_idl_txn_commit(default_vlan_txn);
+        if (status != TXN_INCOMPLETE) {
+            default_vlan_txn_done(status);
+        }
+        return;
+    }
+
+    if (default_vlan_exists()) {
+        VLOG_DBG("Default VLAN already created, skipping");
+        default_vlan_created = true;
+        return;
+    }
+
+    if (!writes_enabled) {
+        return;
+    }
+
+    snprintf(vlan_name, sizeof(vlan_name), "%s%d", "DEFAULT_VLAN_",
+             DEFAULT_VID);
+
+    default_bridge_row = find_default_bridge();
+    if (default_bridge_row == NULL) {
+        /* Bridge table changes wake us up, so just try again then. */
+        if (!bridge_missing_logged) {
+            VLOG_INFO("Waiting for default bridge to create %s", vlan_name);
+            bridge_missing_logged = true;
+        }
+        return;
+    }
+
+    default_vlan_txn = ovsdb_idl_txn_create(idl);
+
+    vlan_row = ovsrec_vlan_insert(default_vlan_txn);
+    ovsrec_vlan_set_id(vlan_row, DEFAULT_VID);
+    ovsrec_vlan_set_name(vlan_row, vlan_name);
+    ovsrec_vlan_set_admin(vlan_row, OVSREC_VLAN_ADMIN_UP);
+    ovsrec_vlan_set_oper_state(vlan_row, OVSREC_VLAN_OPER_STATE_DOWN);
+    ovsrec_vlan_set_oper_state_reason(vlan_row, OVSREC_VLAN_OPER_STATE_REASON_ADMIN_DOWN);
+
+    vlans = xmalloc(sizeof(*default_bridge_row->vlans) *
+        (default_bridge_row->n_vlans + 1));
+
+    for (i = 0; i < default_bridge_row->n_vlans; i++) {
+        vlans[i] = default_bridge_row->vlans[i];
+    }
+
+    vlans[default_bridge_row->n_vlans] = CONST_CAST(struct ovsrec_vlan*,vlan_row);
+    ovsrec_bridge_set_vlans(default_bridge_row, vlans,
+        default_bridge_row->n_vlans + 1);
+
+    free(vlans);
+
+    status = ovsdb_idl_txn_commit(default_vlan_txn);
+    if (status != TXN_INCOMPLETE) {
+        default_vlan_txn_done(status);
+    }
+
+} /* default_vlan_run */
+
+/**************************************************************************//**
+ * This function points every cached VLAN at its current IDL row before the
+ * caches are updated.  The IDL replaces its rows when it reloads the DB,
+ * e.g. after reconnecting to ovsdb-server, and port processing looks at
+ * VLAN rows before update_vlan_cache() runs.  A VLAN whose row is gone is
+ * left with a NULL row until update_vlan_cache() deletes it.
+ *****************************************************************************/
+static void
+rebind_vlan_rows(void)
+{
+    struct vlan_data *vptr;
+
+    HMAP_FOR_EACH(vptr, node, &all_vlans) {
+        vptr->idl_cfg = ovsrec_vlan_get_for_uuid(idl, &vptr->uuid);
+    }
+
+} /* rebind_vlan_rows */
 
 static int
 vland_reconfigure(void)
@@ -1018,19 +2038,32 @@ vland_reconfigure(void)
         return 0;
     }
 
-    /* Update Ports table cache. */
-    if (update_port_cache()) {
-        rc++;
-    }
+    rebind_vlan_rows();
+    index_bridge_ports();
+
+    if (pipeline) {
+        /* The compute stage reports the results later. */
+        pipeline_ingest();
+
+    } else {
+        /* Update Ports table cache. */
+        if (update_port_cache()) {
+            rc++;
+        }
 
-    /* Update VLANs table cache. */
-    if (update_vlan_cache()) {
-        rc++;
+        /* Update VLANs table cache. */
+        if (update_vlan_cache()) {
+            rc++;
+        }
     }
 
     /* Update IDL sequence # after we've handled everything. */
     idl_seqno = new_idl_seqno;
 
+    /* Release everything allocated for this pass in one go. */
+    hmap_clear(&bridge_ports);
+    vland_arena_reset(&run_arena);
+
     return rc;
 
 } /* vland_reconfigure */
@@ -1049,46 +2082,226 @@ vland_chk_for_system_configured(void)
 
     if (sys && sys->cur_cfg > (int64_t) 0) {
         system_configured = true;
+        system_configured_msec = time_msec();
         VLOG_INFO("System is now configured (cur_cfg=%d).",
                   (int)sys->cur_cfg);
     }
 
 } /* vland_chk_for_system_configured */
 
+/* Returns true if the status in the OVSDB row of 'vptr' already matches the
+ * cached status. */
+static bool
+vlan_status_in_sync(const struct vlan_data *vptr)
+{
+    const struct ovsrec_vlan *row = vptr->idl_cfg;
+    const char *hw_enable = smap_get(&row->hw_vlan_config, "enable");
+    bool hw_enabled = hw_enable && !strcmp(hw_enable,
+                                           VLAN_HW_CONFIG_MAP_ENABLE_TRUE);
+
+    if (hw_enabled != (VLAN_OPER_STATE_UP == vptr->op_state)) {
+        return false;
+    }
+    if ((VLAN_OPER_STATE_UP != vptr->op_state) && hw_enable) {
+        return false;
+    }
+
+    return (row->oper_state
+            && !strcmp(row->oper_state,
+                       vlan_oper_state_to_str(vptr->op_state))
+            && row->oper_state_reason
+            && !strcmp(row->oper_state_reason,
+                       vlan_oper_state_reason_to_str(vptr->op_state_reason)));
+
+} /* vlan_status_in_sync */
+
+/**************************************************************************//**
+ * This function is called when a standby vland takes over the lock.  The
+ * caches were kept current while in standby, but the previous owner may
+ * have left some VLAN status unwritten, or written status the caches no
+ * longer agree with.  Compare every cached VLAN against its OVSDB row and
+ * mark exactly the ones that differ dirty, so the following commit fixes
+ * them in a single transaction.
+ *****************************************************************************/
+static void
+vland_reconcile(void)
+{
+    long long int start = time_msec();
+    struct vlan_data *vptr;
+    int n_dirty = 0;
+
+    COVERAGE_INC(vland_reconcile);
+
+    vland_bitmap_zero(&dirty_vlans_bitmap);
+    HMAP_FOR_EACH(vptr, node, &all_vlans) {
+        /* Skip VLANs whose state has not been computed, i.e. internal
+         * VLANs and, in pipelined mode, VLANs the compute stage has not
+         * reported on yet.  The latter are marked dirty when it does. */
+        if (vptr->op_state == VLAN_OPER_STATE_UNKNOWN) {
+            continue;
+        }
+
+        if (!vlan_status_in_sync(vptr)) {
+            vland_bitmap_set1(&dirty_vlans_bitmap, vptr->vid);
+            n_dirty++;
+        }
+    }
+    txn_backoff_msec = 0;
+    txn_retry_time = LLONG_MIN;
+
+    VLOG_INFO("Reconciled %"PRIuSIZE" VLANs with OVSDB in %lld ms, "
+              "%d need updating", hmap_count(&all_vlans),
+              time_msec() - start, n_dirty);
+
+} /* vland_reconcile */
+
+/* Returns true if there are dirty VLANs and their commit is not being held
+ * back by the retry backoff or by the default VLAN transaction. */
+static bool
+vland_commit_due(void)
+{
+    return (!vland_bitmap_is_empty(&dirty_vlans_bitmap) &&
+            time_msec() >= txn_retry_time && !default_vlan_txn);
+
+} /* vland_commit_due */
+
+/**************************************************************************//**
+ * This function commits the status of all dirty VLANs in one transaction.
+ * On success the VLANs are marked clean.  On a conflict or failure they stay
+ * dirty, and the commit is retried with exponential backoff; by then the
+ * retry also carries any status changes made in the meantime.
+ *
+ * @return true if a transaction was committed successfully, false if there
+ *         was nothing to commit, the commit was held back, or it failed.
+ *****************************************************************************/
+static bool
+vland_commit_dirty_vlans(void)
+{
+    static struct vlog_rate_limit rl = VLOG_RATE_LIMIT_INIT(1, 5);
+    struct ovsdb_idl_txn *txn;
+    enum ovsdb_idl_txn_status status;
+    bool committed = false;
+    int vid;
+
+    if (!vland_commit_due()) {
+        return false;
+    }
+
+    txn = ovsdb_idl_txn_create(idl);
+    VLAND_BITMAP_FOR_EACH_1(vid, &dirty_vlans_bitmap) {
+        struct vlan_data *vlan = vlan_lookup_by_vid(vid);
+        if (vlan) {
+            write_vlan_status(vlan);
+        } else {
+            vland_bitmap_set0(&dirty_vlans_bitmap, vid);
+        }
+    }
+
+    COVERAGE_INC(vland_txn_commit);
+    status = ovsdb_idl_txn_commit_block(txn);
+    if (status == TXN_SUCCESS || status == TXN_UNCHANGED) {
+        vland_bitmap_zero(&dirty_vlans_bitmap);
+        txn_backoff_msec = 0;
+        txn_retry_time = LLONG_MIN;
+        committed = true;
+    } else {
+        if (status == TXN_TRY_AGAIN) {
+            COVERAGE_INC(vland_txn_conflict);
+        } else {
+            COVERAGE_INC(vland_txn_error);
+        }
+        txn_backoff_msec = (txn_backoff_msec
+                            ? MIN(txn_backoff_msec * 2, TXN_BACKOFF_MAX_MSEC)
+                            : TXN_BACKOFF_MIN_MSEC);
+        txn_retry_time = time_msec() + txn_backoff_msec;
+        VLOG_WARN_RL(&rl, "VLAN status commit failed (%s), retrying in %d ms",
+                     ovsdb_idl_txn_status_to_string(status),
+                     txn_backoff_msec);
+    }
+    ovsdb_idl_txn_destroy(txn);
+
+    return committed;
+
+} /* vland_commit_dirty_vlans */
+
 void
 vland_run(void)
 {
-    struct ovsdb_idl_txn *txn;
+    long long int start = time_usec();
 
     /* Process a batch of messages from OVSDB. */
     ovsdb_idl_run(idl);
+    idl_run_usec += time_usec() - start;
+    idl_run_count++;
 
-    if (ovsdb_idl_is_lock_contended(idl)) {
-        static struct vlog_rate_limit rl = VLOG_RATE_LIMIT_INIT(1, 1);
-
-        VLOG_ERR_RL(&rl, "Another vland process is running, "
-                    "disabling this process until it goes away");
+    if (ovsdb_idl_has_lock(idl)) {
+        if (!vland_active) {
+            VLOG_INFO("Acquired the ops_vland lock, becoming active");
+            vland_active = true;
+        }
+    } else {
+        if (vland_active) {
+            VLOG_WARN("Lost the ops_vland lock, entering standby");
+            vland_active = false;
+        }
+        if (ovsdb_idl_is_lock_contended(idl)) {
+            static struct vlog_rate_limit rl = VLOG_RATE_LIMIT_INIT(1, 60);
 
-        return;
-    } else if (!ovsdb_idl_has_lock(idl)) {
-        return;
+            VLOG_INFO_RL(&rl, "Another vland process is running, "
+                         "standing by until it goes away");
+        }
     }
 
-    /* Update the local configuration and push any changes to the DB.
-     * Only do this after the system has been configured by CFGD, i.e.
-     * table System "cur_cfg" > 1. */
+    /* Writes to the DB are only allowed once we hold the lock and the
+     * system has been configured by CFGD, i.e. table System "cur_cfg" > 0.
+     * Whenever they become allowed, the caches are reconciled with the DB
+     * first. */
     vland_chk_for_system_configured();
-    if (system_configured) {
-        if (!default_vlan_created) {
-            create_default_vlan();
+    if (vland_active && system_configured) {
+        if (!writes_enabled) {
+            writes_enabled = true;
+            reconcile_pending = true;
         }
+    } else {
+        writes_enabled = false;
+    }
 
-        txn = ovsdb_idl_txn_create(idl);
-        if (vland_reconfigure()) {
-            /* Some OVSDB write needs to happen. */
-            ovsdb_idl_txn_commit_block(txn);
+    /* Pick up the VLAN states computed since the last pass. */
+    if (pipeline) {
+        pipeline_collect();
+    }
+
+    /* Fast path: nothing we act on changed in the DB and no status
+     * commit is due. */
+    if (default_vlan_created &&
+        ovsdb_idl_get_seqno(idl) == idl_seqno && !reconcile_pending &&
+        !(writes_enabled && vland_commit_due())) {
+        COVERAGE_INC(vland_wakeup_noop);
+        return;
+    }
+    COVERAGE_INC(vland_wakeup_work);
+
+    if (!default_vlan_created) {
+        default_vlan_run();
+        vland_update_monitor_conditions();
+    }
+
+    /* Caches are built from the first IDL snapshot on and kept current
+     * while writes are held back, so that once they are allowed only one
+     * reconciliation pass is needed. */
+    vland_reconfigure();
+
+    if (writes_enabled) {
+        if (reconcile_pending) {
+            vland_reconcile();
+            reconcile_pending = false;
+        }
+        if (vland_commit_dirty_vlans() && !first_commit_logged) {
+            VLOG_INFO("First VLAN status commit done %lld ms after "
+                      "the system was configured",
+                      time_msec() - system_configured_msec);
+            first_commit_logged = true;
         }
-        ovsdb_idl_txn_destroy(txn);
     }
 
     return;
@@ -1100,6 +2313,22 @@ vland_wait(void)
 {
     ovsdb_idl_wait(idl);
 
+    if (pipeline) {
+        vland_pipeline_wait(pipeline);
+    }
+
+    if (default_vlan_txn) {
+        ovsdb_idl_txn_wait(default_vlan_txn);
+    }
+
+    /* Wake up to retry any status commit that failed.  Nothing is
+     * committed while writes are held back, so there is no reason to wake
+     * up for this then. */
+    if (writes_enabled && !default_vlan_txn &&
+        !vland_bitmap_is_empty(&dirty_vlans_bitmap)) {
+        poll_timer_wait_until(txn_retry_time);
+    }
+
 } /* vland_wait */
 
 bool vland_default_vlan_member_port(void)
@@ -1107,7 +2336,6 @@ bool vland_default_vlan_member_port(void)
     const struct ovsrec_port *port_row = NULL;
     const struct ovsrec_vlan *vlan_row = NULL;
     bool default_vlan_found = false;
-    int index = 0;
 
     vlan_row = ovsrec_vlan_first(idl);
     if (vlan_row != NULL) {
@@ -1124,24 +2352,9 @@ bool vland_default_vlan_member_port(void)
         if (port_row != NULL) {
             /* Checking for Each port*/
             OVSREC_PORT_FOR_EACH(port_row, idl) {
-                if (port_row->vlan_tag != NULL) {
-                    /* Checking if Default VLAN is a part of tag column */
-                    if (ops_port_get_tag(port_row) == DEFAULT_VID) {
-                        default_vlan_found = true;
-                        break;
-                    }
-                }
-                else if (port_row->n_vlan_trunks > 0) {
-                    for (index = 0; index < port_row->n_vlan_trunks; index++)
-                    {
-                        /* Checking if Default VLAN is a part of trunk column */
-                        if (ops_port_get_trunks(port_row, index) == DEFAULT_VID) {
-                            default_vlan_found = true;
-                            break;
-                        }
-                    }
-                }
-                if (default_vlan_found) {
+                /* Checking if Default VLAN is a part of tag or trunk column */
+                if (port_row_has_default_vlan(port_row)) {
+                    default_vlan_found = true;
                     break;
                 }
             }
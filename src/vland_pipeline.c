@@ -0,0 +1,494 @@
+/*
+ * (C) Copyright 2016 Hewlett Packard Enterprise Development LP
+ * All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/*************************************************************************//**
+ * @ingroup ops-vland
+ *
+ * @file
+ * Compute stage of the pipelined mode.  See vland_pipeline.h.
+ *
+ * Instead of scanning every port for each VLAN it touches, as the main loop
+ * does, the compute stage keeps a count of in-bridge member ports per VLAN.
+ * Applying a port change subtracts the port's old VLANs from the counts and
+ * adds its new ones, and only the VLANs touched are evaluated again.  Ports
+ * that trunk all VLANs are kept as a single count, since they are members
+ * of every VLAN.
+ ****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <hmap.h>
+#include <latch.h>
+#include <ovs-atomic.h>
+#include <ovs-thread.h>
+#include <poll-loop.h>
+#include <seq.h>
+#include <timeval.h>
+#include <util.h>
+#include <uuid.h>
+#include <openvswitch/vlog.h>
+
+#include "vland_bitmap.h"
+#include "vland_oper_state.h"
+#include "vland_pipeline.h"
+#include "vland_ring.h"
+#include "vlan_set.h"
+
+VLOG_DEFINE_THIS_MODULE(vland_pipeline);
+
+#define VALID_VID(x)  ((x)>0 && (x)<4095)
+
+/* Most change records applied before the resulting deltas are handed to the
+ * main thread, so that a long burst of changes does not hold them back. */
+#define PIPELINE_MAX_CHANGES  4096
+
+struct pipeline_port {
+    struct hmap_node node;      /* In 'ports', hashed by 'uuid'. */
+    struct uuid uuid;
+    bool in_bridge;
+    bool trunk_all;
+    bool default_member;
+    struct vlan_set vids;       /* Trunks and native VLAN. */
+};
+
+struct pipeline_vlan {
+    struct uuid uuid;           /* UUID of the VLAN's row. */
+    bool exists;
+    bool admin_up;
+    bool internal;
+    bool reported;              /* 'state' and 'reason' were sent out. */
+    enum ovsrec_vlan_oper_state_e state;
+    enum ovsrec_vlan_oper_state_reason_e reason;
+};
+
+struct vland_pipeline {
+    /* Shared by both threads. */
+    struct vland_ring *changes;         /* Main thread to compute thread. */
+    struct vland_ring *deltas;          /* Compute thread to main thread. */
+    struct seq *compute_seq;            /* Wakes up the compute thread. */
+    struct seq *main_seq;               /* Wakes up the main thread. */
+    struct latch exit_latch;
+    pthread_t thread;
+
+    /* Written by the compute thread, read by anyone. */
+    atomic_uint64_t n_changes;
+    atomic_uint64_t n_batches;
+    atomic_uint64_t n_deltas;
+    atomic_uint64_t compute_usec;
+
+    /* Main thread only. */
+    uint64_t main_seqno;
+
+    /* Compute thread only. */
+    struct hmap ports;
+    struct pipeline_vlan vlans[VLAND_BITMAP_BITS];
+    uint32_t n_members[VLAND_BITMAP_BITS];  /* In-bridge ports per VID. */
+    size_t n_trunk_all;                 /* In-bridge ports trunking all. */
+    size_t n_default_members;           /* Ports with the default VLAN. */
+    struct vland_bitmap affected;       /* VLANs to evaluate again. */
+    bool all_affected;                  /* Evaluate every VLAN again. */
+    struct vland_bitmap scratch;
+    struct vland_state_delta *out;      /* Deltas of the current batch. */
+    size_t n_out;
+    size_t allocated_out;
+    struct vland_delta_batch *pending;  /* Batch waiting for ring room. */
+};
+
+struct vland_change *
+vland_change_create(enum vland_change_type type, size_t n_trunks)
+{
+    struct vland_change *change;
+
+    change = xzalloc(sizeof *change + n_trunks * sizeof change->trunks[0]);
+    change->type = type;
+    change->native_vid = -1;
+    change->n_trunks = n_trunks;
+
+    return change;
+
+} /* vland_change_create */
+
+/**********************************************************************/
+/*                           Compute thread                           */
+/**********************************************************************/
+static struct pipeline_port *
+pipeline_port_find(const struct vland_pipeline *p, const struct uuid *uuid)
+{
+    struct pipeline_port *port;
+
+    HMAP_FOR_EACH_WITH_HASH(port, node, uuid_hash(uuid), &p->ports) {
+        if (uuid_equals(&port->uuid, uuid)) {
+            return port;
+        }
+    }
+    return NULL;
+
+} /* pipeline_port_find */
+
+/* Adds the memberships of 'port' to the counts, or removes them if 'add' is
+ * false, and marks the VLANs they affect. */
+static void
+pipeline_port_count(struct vland_pipeline *p,
+                    const struct pipeline_port *port, bool add)
+{
+    struct vlan_set_iter iter;
+    int vid;
+
+    if (port->default_member) {
+        p->n_default_members += add ? 1 : -1;
+        vland_bitmap_set1(&p->affected, VLAND_DEFAULT_VID);
+    }
+
+    if (!port->in_bridge) {
+        return;
+    }
+
+    if (port->trunk_all) {
+        p->n_trunk_all += add ? 1 : -1;
+        p->all_affected = true;
+    }
+    VLAN_SET_FOR_EACH(vid, iter, &port->vids) {
+        p->n_members[vid] += add ? 1 : -1;
+        vland_bitmap_set1(&p->affected, vid);
+    }
+
+} /* pipeline_port_count */
+
+static void
+pipeline_apply_port(struct vland_pipeline *p,
+                    const struct vland_change *change)
+{
+    struct pipeline_port *port = pipeline_port_find(p, &change->uuid);
+    size_t i;
+
+    if (port) {
+        pipeline_port_count(p, port, false);
+    }
+
+    if (change->type == VLAND_CHANGE_PORT_DEL) {
+        if (port) {
+            hmap_remove(&p->ports, &port->node);
+            vlan_set_destroy(&port->vids);
+            free(port);
+        }
+        return;
+    }
+
+    if (!port) {
+        port = xmalloc(sizeof *port);
+        port->uuid = change->uuid;
+        vlan_set_init(&port->vids);
+        hmap_insert(&p->ports, &port->node, uuid_hash(&port->uuid));
+    }
+
+    port->in_bridge = change->in_bridge;
+    port->trunk_all = change->trunk_all;
+    port->default_member = change->default_member;
+
+    vland_bitmap_zero(&p->scratch);
+    for (i = 0; i < change->n_trunks; i++) {
+        if (change->trunks[i] < VLAND_BITMAP_BITS) {
+            vland_bitmap_set1(&p->scratch, change->trunks[i]);
+        }
+    }
+    if (VALID_VID(change->native_vid)) {
+        vland_bitmap_set1(&p->scratch, change->native_vid);
+    }
+    vlan_set_from_bitmap(&port->vids, &p->scratch);
+
+    pipeline_port_count(p, port, true);
+
+} /* pipeline_apply_port */
+
+static void
+pipeline_apply_vlan(struct vland_pipeline *p,
+                    const struct vland_change *change)
+{
+    struct pipeline_vlan *vlan;
+
+    if (change->vid < 0 || change->vid >= VLAND_BITMAP_BITS) {
+        return;
+    }
+    vlan = &p->vlans[change->vid];
+
+    if (change->type == VLAND_CHANGE_VLAN_DEL) {
+        if (uuid_equals(&vlan->uuid, &change->uuid)) {
+            memset(vlan, 0, sizeof *vlan);
+        }
+        return;
+    }
+
+    if (!uuid_equals(&vlan->uuid, &change->uuid)) {
+        /* A different row now has this VID; its state is reported anew. */
+        memset(vlan, 0, sizeof *vlan);
+        vlan->uuid = change->uuid;
+    }
+    vlan->exists = true;
+    vlan->admin_up = change->admin_up;
+    vlan->internal = change->internal;
+    vland_bitmap_set1(&p->affected, change->vid);
+
+} /* pipeline_apply_vlan */
+
+/* Computes the state of VLAN 'vid' and queues a delta if it changed. */
+static void
+pipeline_vlan_evaluate(struct vland_pipeline *p, int vid)
+{
+    struct pipeline_vlan *vlan = &p->vlans[vid];
+    enum ovsrec_vlan_oper_state_e state;
+    enum ovsrec_vlan_oper_state_reason_e reason;
+    struct vland_state_delta *delta;
+    bool any_member;
+
+    /* VLANs used internally for L3 interfaces are left alone. */
+    if (!vlan->exists || vlan->internal) {
+        return;
+    }
+
+    any_member = (p->n_members[vid] || p->n_trunk_all
+                  || (vid == VLAND_DEFAULT_VID && p->n_default_members));
+    vland_oper_state_calc(vid, vlan->admin_up, any_member, &state, &reason);
+    if (vlan->reported && state == vlan->state && reason == vlan->reason) {
+        return;
+    }
+    vlan->reported = true;
+    vlan->state = state;
+    vlan->reason = reason;
+
+    if (p->n_out >= p->allocated_out) {
+        p->out = x2nrealloc(p->out, &p->allocated_out, sizeof *p->out);
+    }
+    delta = &p->out[p->n_out++];
+    delta->uuid = vlan->uuid;
+    delta->vid = vid;
+    delta->any_member = any_member;
+    delta->state = state;
+    delta->reason = reason;
+
+} /* pipeline_vlan_evaluate */
+
+/* Applies up to PIPELINE_MAX_CHANGES records and queues the resulting
+ * deltas.  Returns true if it made any progress. */
+static bool
+pipeline_compute(struct vland_pipeline *p)
+{
+    struct vland_change *change;
+    struct vland_delta_batch *batch;
+    long long int start;
+    uint64_t orig;
+    size_t n = 0;
+    int vid;
+
+    /* Nothing new is applied until the previous batch is handed over. */
+    if (p->pending) {
+        if (!vland_ring_push(p->deltas, p->pending)) {
+            return false;
+        }
+        p->pending = NULL;
+        seq_change(p->main_seq);
+    }
+
+    start = time_usec();
+    while (n < PIPELINE_MAX_CHANGES
+           && (change = vland_ring_pop(p->changes)) != NULL) {
+        switch (change->type) {
+        case VLAND_CHANGE_PORT:
+        case VLAND_CHANGE_PORT_DEL:
+            pipeline_apply_port(p, change);
+            break;
+        case VLAND_CHANGE_VLAN:
+        case VLAND_CHANGE_VLAN_DEL:
+            pipeline_apply_vlan(p, change);
+            break;
+        }
+        free(change);
+        n++;
+    }
+    if (!n) {
+        return false;
+    }
+
+    if (p->all_affected) {
+        for (vid = 0; vid < VLAND_BITMAP_BITS; vid++) {
+            pipeline_vlan_evaluate(p, vid);
+        }
+    } else {
+        VLAND_BITMAP_FOR_EACH_1(vid, &p->affected) {
+            pipeline_vlan_evaluate(p, vid);
+        }
+    }
+    vland_bitmap_zero(&p->affected);
+    p->all_affected = false;
+
+    atomic_add_relaxed(&p->n_changes, n, &orig);
+    atomic_add_relaxed(&p->compute_usec, time_usec() - start, &orig);
+
+    if (p->n_out) {
+        batch = xmalloc(sizeof *batch + p->n_out * sizeof *batch->deltas);
+        batch->n = p->n_out;
+        memcpy(batch->deltas, p->out, p->n_out * sizeof *batch->deltas);
+        p->n_out = 0;
+
+        atomic_add_relaxed(&p->n_batches, 1, &orig);
+        atomic_add_relaxed(&p->n_deltas, batch->n, &orig);
+        if (!vland_ring_push(p->deltas, batch)) {
+            p->pending = batch;
+        }
+    }
+
+    /* Tell the main thread about the new batch, and that there is room
+     * for more changes. */
+    seq_change(p->main_seq);
+    return true;
+
+} /* pipeline_compute */
+
+static void *
+pipeline_main(void *p_)
+{
+    struct vland_pipeline *p = p_;
+
+    while (!latch_is_set(&p->exit_latch)) {
+        uint64_t seqno = seq_read(p->compute_seq);
+
+        if (!pipeline_compute(p)) {
+            seq_wait(p->compute_seq, seqno);
+            latch_wait(&p->exit_latch);
+            poll_block();
+        }
+    }
+    return NULL;
+
+} /* pipeline_main */
+
+/**********************************************************************/
+/*                            Main thread                             */
+/**********************************************************************/
+struct vland_pipeline *
+vland_pipeline_create(size_t capacity)
+{
+    struct vland_pipeline *p = xzalloc_cacheline(sizeof *p);
+
+    p->changes = vland_ring_create(capacity);
+    p->deltas = vland_ring_create(capacity);
+    p->compute_seq = seq_create();
+    p->main_seq = seq_create();
+    latch_init(&p->exit_latch);
+    atomic_init(&p->n_changes, 0);
+    atomic_init(&p->n_batches, 0);
+    atomic_init(&p->n_deltas, 0);
+    atomic_init(&p->compute_usec, 0);
+    hmap_init(&p->ports);
+
+    p->thread = ovs_thread_create("vland_compute", pipeline_main, p);
+    VLOG_INFO("Started pipelined compute thread, %"PRIuSIZE" record ring",
+              vland_ring_capacity(p->changes));
+
+    return p;
+
+} /* vland_pipeline_create */
+
+void
+vland_pipeline_destroy(struct vland_pipeline *p)
+{
+    struct pipeline_port *port, *next;
+    void *item;
+
+    if (!p) {
+        return;
+    }
+
+    latch_set(&p->exit_latch);
+    xpthread_join(p->thread, NULL);
+
+    while ((item = vland_ring_pop(p->changes)) != NULL) {
+        free(item);
+    }
+    while ((item = vland_ring_pop(p->deltas)) != NULL) {
+        free(item);
+    }
+    free(p->pending);
+    free(p->out);
+
+    HMAP_FOR_EACH_SAFE (port, next, node, &p->ports) {
+        hmap_remove(&p->ports, &port->node);
+        vlan_set_destroy(&port->vids);
+        free(port);
+    }
+    hmap_destroy(&p->ports);
+
+    vland_ring_destroy(p->changes);
+    vland_ring_destroy(p->deltas);
+    seq_destroy(p->compute_seq);
+    seq_destroy(p->main_seq);
+    latch_destroy(&p->exit_latch);
+    free_cacheline(p);
+
+} /* vland_pipeline_destroy */
+
+bool
+vland_pipeline_submit(struct vland_pipeline *p, struct vland_change *change)
+{
+    return vland_ring_push(p->changes, change);
+
+} /* vland_pipeline_submit */
+
+void
+vland_pipeline_flush(struct vland_pipeline *p)
+{
+    seq_change(p->compute_seq);
+
+} /* vland_pipeline_flush */
+
+struct vland_delta_batch *
+vland_pipeline_next_deltas(struct vland_pipeline *p)
+{
+    struct vland_delta_batch *batch;
+
+    /* Read the seq before looking at the ring, so that a batch pushed after
+     * this check still wakes up vland_pipeline_wait(). */
+    p->main_seqno = seq_read(p->main_seq);
+    batch = vland_ring_pop(p->deltas);
+    if (batch) {
+        /* The compute thread may be waiting for room in the ring. */
+        seq_change(p->compute_seq);
+    }
+
+    return batch;
+
+} /* vland_pipeline_next_deltas */
+
+void
+vland_pipeline_wait(struct vland_pipeline *p)
+{
+    seq_wait(p->main_seq, p->main_seqno);
+
+} /* vland_pipeline_wait */
+
+void
+vland_pipeline_get_stats(const struct vland_pipeline *p_,
+                         struct vland_pipeline_stats *stats)
+{
+    struct vland_pipeline *p = CONST_CAST(struct vland_pipeline *, p_);
+
+    atomic_read_relaxed(&p->n_changes, &stats->n_changes);
+    atomic_read_relaxed(&p->n_batches, &stats->n_batches);
+    atomic_read_relaxed(&p->n_deltas, &stats->n_deltas);
+    atomic_read_relaxed(&p->compute_usec, &stats->compute_usec);
+
+} /* vland_pipeline_get_stats */
@@ -0,0 +1,137 @@
+/*
+ * (C) Copyright 2016 Hewlett Packard Enterprise Development LP
+ * All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/*************************************************************************//**
+ * @ingroup ops-vland
+ *
+ * @file
+ * Fixed-size object pool for long-lived cache entries of the OpenSwitch
+ * VLAN daemon.
+ ****************************************************************************/
+
+#include <string.h>
+
+#include <util.h>
+
+#include "vland_pool.h"
+
+/* Slab header.  It takes a whole cache line so that the objects after it
+ * stay cache-line aligned. */
+struct vland_pool_slab {
+    struct vland_pool_slab *next;
+    char pad[CACHE_LINE_SIZE - sizeof(struct vland_pool_slab *)];
+};
+
+/* A free object holds the link to the next free object. */
+struct vland_pool_free {
+    struct vland_pool_free *next;
+};
+
+void
+vland_pool_init(struct vland_pool *pool, size_t obj_size,
+                size_t objs_per_slab)
+{
+    pool->obj_size = ROUND_UP(MAX(obj_size, sizeof(struct vland_pool_free)),
+                              CACHE_LINE_SIZE);
+    pool->objs_per_slab = MAX(objs_per_slab, 1);
+    pool->slabs = NULL;
+    pool->free_list = NULL;
+    pool->n_slabs = 0;
+    pool->n_used = 0;
+
+} /* vland_pool_init */
+
+void
+vland_pool_destroy(struct vland_pool *pool)
+{
+    struct vland_pool_slab *slab = pool->slabs;
+
+    while (slab) {
+        struct vland_pool_slab *next = slab->next;
+        free_cacheline(slab);
+        slab = next;
+    }
+    pool->slabs = NULL;
+    pool->free_list = NULL;
+    pool->n_slabs = 0;
+    pool->n_used = 0;
+
+} /* vland_pool_destroy */
+
+/* Adds a new slab to 'pool' and puts all of its objects on the free list. */
+static void
+vland_pool_grow(struct vland_pool *pool)
+{
+    struct vland_pool_slab *slab;
+    char *objs;
+    size_t i;
+
+    slab = xmalloc_cacheline(sizeof *slab
+                             + pool->obj_size * pool->objs_per_slab);
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    pool->n_slabs++;
+
+    /* Thread the objects so that they are handed out in address order. */
+    objs = (char *) (slab + 1);
+    for (i = pool->objs_per_slab; i-- > 0; ) {
+        struct vland_pool_free *obj
+            = (struct vland_pool_free *) (objs + i * pool->obj_size);
+        obj->next = pool->free_list;
+        pool->free_list = obj;
+    }
+
+} /* vland_pool_grow */
+
+void *
+vland_pool_alloc(struct vland_pool *pool)
+{
+    struct vland_pool_free *obj;
+
+    if (!pool->free_list) {
+        vland_pool_grow(pool);
+    }
+
+    obj = pool->free_list;
+    pool->free_list = obj->next;
+    pool->n_used++;
+
+    memset(obj, 0, pool->obj_size);
+    return obj;
+
+} /* vland_pool_alloc */
+
+void
+vland_pool_free(struct vland_pool *pool, void *obj_)
+{
+    struct vland_pool_free *obj = obj_;
+
+    if (obj) {
+        obj->next = pool->free_list;
+        pool->free_list = obj;
+        pool->n_used--;
+    }
+
+} /* vland_pool_free */
+
+size_t
+vland_pool_bytes(const struct vland_pool *pool)
+{
+    return pool->n_slabs * (sizeof(struct vland_pool_slab)
+                            + pool->obj_size * pool->objs_per_slab);
+
+} /* vland_pool_bytes */
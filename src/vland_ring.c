@@ -0,0 +1,130 @@
+/*
+ * (C) Copyright 2016 Hewlett Packard Enterprise Development LP
+ * All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/*************************************************************************//**
+ * @ingroup ops-vland
+ *
+ * @file
+ * Single-producer, single-consumer pointer ring.  See vland_ring.h.
+ *
+ * 'head' and 'tail' count pushes and pops since creation and only ever
+ * grow; a slot's index is the count masked by the capacity.  The producer
+ * publishes a slot by storing 'head' with release semantics after writing
+ * the slot, and the consumer hands the slot back by storing 'tail' the same
+ * way after reading it.  Each side also keeps a private copy of the other
+ * side's counter and only reloads it when the copy says the ring is full or
+ * empty, so in steady state the two threads do not share a cache line.
+ ****************************************************************************/
+
+#include <stdint.h>
+
+#include <ovs-atomic.h>
+#include <util.h>
+
+#include "vland_ring.h"
+
+struct vland_ring {
+    /* Set at creation, read-only after. */
+    void **slots;
+    size_t mask;
+
+    /* Producer. */
+    atomic_size_t head __attribute__((aligned(CACHE_LINE_SIZE)));
+    size_t tail_cache;
+
+    /* Consumer. */
+    atomic_size_t tail __attribute__((aligned(CACHE_LINE_SIZE)));
+    size_t head_cache;
+};
+
+struct vland_ring *
+vland_ring_create(size_t capacity)
+{
+    struct vland_ring *ring;
+    size_t n = 1;
+
+    while (n < capacity) {
+        n <<= 1;
+    }
+
+    ring = xzalloc_cacheline(sizeof *ring);
+    ring->slots = xcalloc(n, sizeof *ring->slots);
+    ring->mask = n - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+
+    return ring;
+
+} /* vland_ring_create */
+
+void
+vland_ring_destroy(struct vland_ring *ring)
+{
+    if (ring) {
+        free(ring->slots);
+        free_cacheline(ring);
+    }
+
+} /* vland_ring_destroy */
+
+size_t
+vland_ring_capacity(const struct vland_ring *ring)
+{
+    return ring->mask + 1;
+
+} /* vland_ring_capacity */
+
+bool
+vland_ring_push(struct vland_ring *ring, void *p)
+{
+    size_t head;
+
+    atomic_read_relaxed(&ring->head, &head);
+    if (head - ring->tail_cache > ring->mask) {
+        atomic_read_explicit(&ring->tail, &ring->tail_cache,
+                             memory_order_acquire);
+        if (head - ring->tail_cache > ring->mask) {
+            return false;
+        }
+    }
+
+    ring->slots[head & ring->mask] = p;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return true;
+
+} /* vland_ring_push */
+
+void *
+vland_ring_pop(struct vland_ring *ring)
+{
+    size_t tail;
+    void *p;
+
+    atomic_read_relaxed(&ring->tail, &tail);
+    if (tail == ring->head_cache) {
+        atomic_read_explicit(&ring->head, &ring->head_cache,
+                             memory_order_acquire);
+        if (tail == ring->head_cache) {
+            return NULL;
+        }
+    }
+
+    p = ring->slots[tail & ring->mask];
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return p;
+
+} /* vland_ring_pop */
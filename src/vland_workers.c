@@ -0,0 +1,145 @@
+/*
+ * (C) Copyright 2016 Hewlett Packard Enterprise Development LP
+ * All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/*************************************************************************//**
+ * @ingroup ops-vland
+ *
+ * @file
+ * Fork-join worker pool for bulk ops-vland work.  See vland_workers.h.
+ ****************************************************************************/
+
+#include <stdlib.h>
+
+#include <ovs-thread.h>
+#include <util.h>
+#include <openvswitch/vlog.h>
+
+#include "vland_workers.h"
+
+VLOG_DEFINE_THIS_MODULE(vland_workers);
+
+struct vland_worker {
+    struct vland_workers *pool;
+    size_t idx;
+    pthread_t thread;
+};
+
+struct vland_workers {
+    size_t n;                       /* Workers, counting the caller. */
+    struct vland_worker *workers;   /* Workers 1 to n - 1. */
+
+    /* The job, set by the caller before 'start' is released. */
+    vland_work_func *func;
+    void *aux;
+    bool exiting;
+
+    struct ovs_barrier start;       /* Released when a job is posted. */
+    struct ovs_barrier done;        /* Released when all have finished. */
+};
+
+static void *
+vland_worker_main(void *worker_)
+{
+    struct vland_worker *worker = worker_;
+    struct vland_workers *pool = worker->pool;
+
+    for (;;) {
+        ovs_barrier_block(&pool->start);
+        if (pool->exiting) {
+            break;
+        }
+        pool->func(pool->aux, worker->idx, pool->n);
+        ovs_barrier_block(&pool->done);
+    }
+    return NULL;
+
+} /* vland_worker_main */
+
+struct vland_workers *
+vland_workers_create(size_t n_threads)
+{
+    struct vland_workers *pool;
+    size_t i;
+
+    if (n_threads < 2) {
+        return NULL;
+    }
+
+    pool = xzalloc(sizeof *pool);
+    pool->n = n_threads;
+    pool->workers = xcalloc(n_threads, sizeof *pool->workers);
+    ovs_barrier_init(&pool->start, n_threads);
+    ovs_barrier_init(&pool->done, n_threads);
+
+    for (i = 1; i < n_threads; i++) {
+        struct vland_worker *worker = &pool->workers[i];
+
+        worker->pool = pool;
+        worker->idx = i;
+        worker->thread = ovs_thread_create("vland_worker", vland_worker_main,
+                                           worker);
+    }
+    VLOG_INFO("Started %"PRIuSIZE" worker threads", n_threads - 1);
+
+    return pool;
+
+} /* vland_workers_create */
+
+void
+vland_workers_destroy(struct vland_workers *pool)
+{
+    size_t i;
+
+    if (!pool) {
+        return;
+    }
+
+    pool->exiting = true;
+    ovs_barrier_block(&pool->start);
+    for (i = 1; i < pool->n; i++) {
+        xpthread_join(pool->workers[i].thread, NULL);
+    }
+    ovs_barrier_destroy(&pool->start);
+    ovs_barrier_destroy(&pool->done);
+    free(pool->workers);
+    free(pool);
+
+} /* vland_workers_destroy */
+
+size_t
+vland_workers_count(const struct vland_workers *pool)
+{
+    return pool ? pool->n : 1;
+
+} /* vland_workers_count */
+
+void
+vland_workers_run(struct vland_workers *pool, vland_work_func *func,
+                  void *aux)
+{
+    if (!pool) {
+        func(aux, 0, 1);
+        return;
+    }
+
+    pool->func = func;
+    pool->aux = aux;
+    ovs_barrier_block(&pool->start);
+    func(aux, 0, pool->n);
+    ovs_barrier_block(&pool->done);
+
+} /* vland_workers_run */
@@ -0,0 +1,365 @@
+/*
+ * (C) Copyright 2016 Hewlett Packard Enterprise Development LP
+ * All Rights Reserved.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/*************************************************************************//**
+ * @ingroup ops-vland
+ *
+ * @file
+ * Unit test for vlan_set.  Walks a set through every representation
+ * transition, then cross-checks random updates against a plain array of
+ * flags.
+ ****************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vland_bitmap.h"
+#include "vlan_set.h"
+
+#define CHECK(COND)                                                     \
+    do {                                                                \
+        if (!(COND)) {                                                  \
+            fprintf(stderr, "%s:%d: check failed: %s\n",                \
+                    __FILE__, __LINE__, #COND);                         \
+            abort();                                                    \
+        }                                                               \
+    } while (0)
+
+/* Reference model: one flag per VID. */
+struct ref_set {
+    bool vids[VLAND_BITMAP_BITS];
+};
+
+static uint32_t rand_state = 1;
+
+static uint32_t
+next_rand(void)
+{
+    /* xorshift32, so that every run sees the same sequence. */
+    rand_state ^= rand_state << 13;
+    rand_state ^= rand_state >> 17;
+    rand_state ^= rand_state << 5;
+    return rand_state;
+
+} /* next_rand */
+
+static void
+ref_to_bitmap(const struct ref_set *ref, struct vland_bitmap *bitmap)
+{
+    int vid;
+
+    vland_bitmap_zero(bitmap);
+    for (vid = 0; vid < VLAND_BITMAP_BITS; vid++) {
+        if (ref->vids[vid]) {
+            vland_bitmap_set1(bitmap, vid);
+        }
+    }
+
+} /* ref_to_bitmap */
+
+/* Checks that 'set' holds exactly the members of 'ref' and that its
+ * representation is within the limits of its type. */
+static void
+check_set(const struct vlan_set *set, const struct ref_set *ref)
+{
+    struct vland_bitmap expected, got;
+    struct vlan_set_iter iter;
+    size_t count = 0;
+    int prev = -1;
+    int vid;
+
+    for (vid = 0; vid < VLAND_BITMAP_BITS; vid++) {
+        CHECK(vlan_set_contains(set, vid) == ref->vids[vid]);
+        count += ref->vids[vid];
+    }
+    CHECK(!vlan_set_contains(set, -1));
+    CHECK(!vlan_set_contains(set, VLAND_BITMAP_BITS));
+    CHECK(vlan_set_count(set) == count);
+    CHECK(vlan_set_is_empty(set) == !count);
+
+    /* Iteration yields every member once, in ascending order. */
+    VLAN_SET_FOR_EACH (vid, iter, set) {
+        CHECK(vid > prev);
+        CHECK(ref->vids[vid]);
+        prev = vid;
+        count--;
+    }
+    CHECK(!count);
+
+    ref_to_bitmap(ref, &expected);
+    vland_bitmap_zero(&got);
+    vlan_set_or_into_bitmap(set, &got);
+    CHECK(!memcmp(&expected, &got, sizeof expected));
+
+    switch (set->type) {
+    case VLAN_SET_ARRAY:
+        CHECK(set->n == set->count);
+        CHECK(set->n <= VLAN_SET_MAX_INLINE);
+        CHECK(!vlan_set_heap_bytes(set));
+        break;
+    case VLAN_SET_RANGES:
+        CHECK(set->n <= set->allocated);
+        CHECK(vlan_set_heap_bytes(set) < sizeof(struct vland_bitmap));
+        break;
+    case VLAN_SET_BITMAP:
+        CHECK(vlan_set_heap_bytes(set) == sizeof(struct vland_bitmap));
+        break;
+    default:
+        CHECK(false);
+    }
+
+} /* check_set */
+
+static void
+set_add(struct vlan_set *set, struct ref_set *ref, int vid)
+{
+    vlan_set_add(set, vid);
+    if (vid >= 0 && vid < VLAND_BITMAP_BITS) {
+        ref->vids[vid] = true;
+    }
+
+} /* set_add */
+
+static void
+set_remove(struct vlan_set *set, struct ref_set *ref, int vid)
+{
+    vlan_set_remove(set, vid);
+    if (vid >= 0 && vid < VLAND_BITMAP_BITS) {
+        ref->vids[vid] = false;
+    }
+
+} /* set_remove */
+
+static void
+set_from_ref(struct vlan_set *set, const struct ref_set *ref)
+{
+    struct vland_bitmap bitmap;
+
+    ref_to_bitmap(ref, &bitmap);
+    vlan_set_from_bitmap(set, &bitmap);
+
+} /* set_from_ref */
+
+/* Walks one set through every representation and every transition
+ * between them. */
+static void
+test_transitions(void)
+{
+    struct vlan_set set = VLAN_SET_INITIALIZER;
+    struct ref_set ref;
+    int vid;
+
+    memset(&ref, 0, sizeof ref);
+    check_set(&set, &ref);
+    CHECK(set.type == VLAN_SET_ARRAY);
+
+    /* Out of range VIDs are ignored. */
+    set_add(&set, &ref, -1);
+    set_add(&set, &ref, VLAND_BITMAP_BITS);
+    check_set(&set, &ref);
+
+    /* ARRAY fills up in any order and stays sorted. */
+    for (vid = VLAN_SET_MAX_INLINE; vid >= 1; vid--) {
+        set_add(&set, &ref, vid * 10);
+        check_set(&set, &ref);
+        CHECK(set.type == VLAN_SET_ARRAY);
+    }
+    set_add(&set, &ref, 10);
+    check_set(&set, &ref);
+    CHECK(set.type == VLAN_SET_ARRAY);
+
+    /* ARRAY -> RANGES when the inline array overflows. */
+    set_add(&set, &ref, 1000);
+    check_set(&set, &ref);
+    CHECK(set.type == VLAN_SET_RANGES);
+
+    /* RANGES merges adjacent VIDs and fills gaps. */
+    for (vid = 11; vid < 80; vid++) {
+        set_add(&set, &ref, vid);
+        check_set(&set, &ref);
+        CHECK(set.type == VLAN_SET_RANGES);
+    }
+
+    /* RANGES splits on remove. */
+    set_remove(&set, &ref, 40);
+    set_remove(&set, &ref, 10);
+    set_remove(&set, &ref, 79);
+    set_remove(&set, &ref, 2000);
+    check_set(&set, &ref);
+    CHECK(set.type == VLAN_SET_RANGES);
+
+    /* RANGES -> BITMAP once the range list would reach a bitmap's size:
+     * every other VID is its own range. */
+    for (vid = 2; vid < 2 + 2 * VLAND_BITMAP_BITS / 8; vid += 2) {
+        set_add(&set, &ref, 1024 + vid);
+        if (set.type != VLAN_SET_RANGES) {
+            break;
+        }
+    }
+    check_set(&set, &ref);
+    CHECK(set.type == VLAN_SET_BITMAP);
+
+    /* BITMAP keeps its type on single updates. */
+    set_add(&set, &ref, 4095);
+    set_remove(&set, &ref, 20);
+    check_set(&set, &ref);
+    CHECK(set.type == VLAN_SET_BITMAP);
+
+    /* from_bitmap picks the representation from the contents:
+     * BITMAP -> ARRAY. */
+    memset(&ref, 0, sizeof ref);
+    ref.vids[1] = ref.vids[4094] = true;
+    set_from_ref(&set, &ref);
+    check_set(&set, &ref);
+    CHECK(set.type == VLAN_SET_ARRAY);
+
+    /* ARRAY -> RANGES. */
+    for (vid = 100; vid < 200; vid++) {
+        ref.vids[vid] = true;
+    }
+    set_from_ref(&set, &ref);
+    check_set(&set, &ref);
+    CHECK(set.type == VLAN_SET_RANGES);
+
+    /* RANGES -> BITMAP. */
+    for (vid = 0; vid < VLAND_BITMAP_BITS; vid += 3) {
+        ref.vids[vid] = true;
+    }
+    set_from_ref(&set, &ref);
+    check_set(&set, &ref);
+    CHECK(set.type == VLAN_SET_BITMAP);
+
+    /* BITMAP -> RANGES. */
+    memset(&ref, 0, sizeof ref);
+    for (vid = 1; vid < VLAND_BITMAP_BITS; vid++) {
+        ref.vids[vid] = true;
+    }
+    set_from_ref(&set, &ref);
+    check_set(&set, &ref);
+    CHECK(set.type == VLAN_SET_RANGES);
+    CHECK(set.n == 1);
+
+    /* A split that would push RANGES past its limit falls back to
+     * BITMAP: punch holes into the single range until it does. */
+    for (vid = 2; vid < VLAND_BITMAP_BITS; vid += 2) {
+        set_remove(&set, &ref, vid);
+        if (set.type != VLAN_SET_RANGES) {
+            break;
+        }
+    }
+    check_set(&set, &ref);
+    CHECK(set.type == VLAN_SET_BITMAP);
+
+    /* BITMAP -> ARRAY, empty. */
+    memset(&ref, 0, sizeof ref);
+    set_from_ref(&set, &ref);
+    check_set(&set, &ref);
+    CHECK(set.type == VLAN_SET_ARRAY);
+
+    vlan_set_destroy(&set);
+
+} /* test_transitions */
+
+/* Returns a random VID, biased towards a few clusters so that ranges
+ * grow, merge and split as well as scatter. */
+static int
+random_vid(void)
+{
+    uint32_t r = next_rand();
+
+    if (r & 1) {
+        return (r >> 1) % VLAND_BITMAP_BITS;
+    }
+    return ((r >> 1) % 4) * 1000 + (r >> 3) % 64;
+
+} /* random_vid */
+
+/* Applies random adds, removes and rebuilds to a few sets and compares
+ * them with the reference model after every step. */
+static void
+test_random(void)
+{
+    enum { N_SETS = 4, N_OPS = 200000 };
+    struct vlan_set sets[N_SETS];
+    struct ref_set refs[N_SETS];
+    bool seen[VLAN_SET_BITMAP + 1] = { false };
+    int i, op;
+
+    for (i = 0; i < N_SETS; i++) {
+        vlan_set_init(&sets[i]);
+        memset(&refs[i], 0, sizeof refs[i]);
+    }
+
+    for (op = 0; op < N_OPS; op++) {
+        uint32_t r = next_rand();
+        struct vlan_set *set = &sets[r % N_SETS];
+        struct ref_set *ref = &refs[r % N_SETS];
+        int vid = random_vid();
+
+        switch ((r >> 8) % 64) {
+        case 0:
+            /* Rebuild, which may change the representation. */
+            set_from_ref(set, ref);
+            break;
+        case 1:
+            /* Start over. */
+            vlan_set_destroy(set);
+            vlan_set_init(set);
+            memset(ref, 0, sizeof *ref);
+            break;
+        default:
+            /* Grow a little faster than shrink so that every set passes
+             * through all three representations. */
+            if ((r >> 16) % 8 < 5) {
+                set_add(set, ref, vid);
+            } else {
+                set_remove(set, ref, vid);
+            }
+            break;
+        }
+
+        CHECK(vlan_set_contains(set, vid) == ref->vids[vid]);
+        seen[set->type] = true;
+        if (!(op % 64)) {
+            check_set(set, ref);
+        }
+    }
+
+    for (i = 0; i <= VLAN_SET_BITMAP; i++) {
+        CHECK(seen[i]);
+    }
+    for (i = 0; i < N_SETS; i++) {
+        check_set(&sets[i], &refs[i]);
+        vlan_set_destroy(&sets[i]);
+    }
+
+} /* test_random */
+
+int
+main(void)
+{
+    vland_bitmap_init();
+
+    test_transitions();
+    test_random();
+
+    return 0;
+
+} /* main */